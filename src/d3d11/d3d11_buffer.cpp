@@ -12,7 +12,8 @@ namespace dxvk {
   : m_device    (pDevice),
     m_desc      (*pDesc),
     m_buffer    (CreateBuffer(pDesc)),
-    m_bufferInfo{ m_buffer->slice() } {
+    m_bufferInfo{ m_buffer->slice() },
+    m_useUniformRing(UseUniformRing(pDesc)) {
     
   }
   
@@ -60,6 +61,33 @@ namespace dxvk {
   }
   
   
+  DxvkPhysicalBufferSlice D3D11Buffer::AllocPhysicalSlice() {
+    DxvkPhysicalBufferSlice slice;
+    
+    if (!this->AllocRingSlice(slice))
+      slice = this->AllocBufferSlice();
+    
+    return slice;
+  }
+  
+  
+  bool D3D11Buffer::AllocRingSlice(
+          DxvkPhysicalBufferSlice&  slice) {
+    if (!m_useUniformRing
+     || !m_device->GetDXVKDevice()->allocUniformSlice(m_desc.ByteWidth, slice))
+      return false;
+    
+    m_ringBacked = true;
+    return true;
+  }
+  
+  
+  DxvkPhysicalBufferSlice D3D11Buffer::AllocBufferSlice() {
+    m_ringBacked = false;
+    return m_buffer->allocPhysicalSlice();
+  }
+  
+  
   Rc<DxvkBuffer> D3D11Buffer::CreateBuffer(
     const D3D11_BUFFER_DESC* pDesc) const {
     DxvkBufferCreateInfo  info;
@@ -142,4 +170,19 @@ namespace dxvk {
     return GetMemoryFlagsForUsage(pDesc->Usage);
   }
   
+  
+  bool D3D11Buffer::UseUniformRing(
+    const D3D11_BUFFER_DESC* pDesc) const {
+    // Constant buffers cannot have any other bind flags, so
+    // the ring buffers can serve all possible buffer usages.
+    // Larger buffers are rarely discarded multiple times per
+    // frame and would only waste space in the ring. This also
+    // applies to default-usage buffers, since those can be
+    // updated through the ring with UpdateSubresource.
+    return pDesc->BindFlags == D3D11_BIND_CONSTANT_BUFFER
+        && pDesc->MiscFlags == 0
+        && pDesc->ByteWidth <= DxvkUniformRing::MaxSliceSize
+        && pDesc->Usage != D3D11_USAGE_IMMUTABLE;
+  }
+  
 }
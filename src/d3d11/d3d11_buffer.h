@@ -64,6 +64,49 @@ namespace dxvk {
       return &m_bufferInfo;
     }
     
+    /**
+     * \brief Allocates new backing storage
+     * 
+     * Used to discard the buffer contents. Small constant
+     * buffers are sub-allocated from the device's uniform
+     * buffer ring if possible, and from the buffer's own
+     * slice pool otherwise.
+     * \returns The new backing buffer slice
+     */
+    DxvkPhysicalBufferSlice AllocPhysicalSlice();
+    
+    /**
+     * \brief Allocates backing storage from the uniform ring
+     * 
+     * Ring slices are always host-visible, even if
+     * the buffer itself is not. Fails if the buffer
+     * cannot use the ring or the ring is exhausted.
+     * \param [out] slice The new backing buffer slice
+     * \returns \c true on success, \c false on failure
+     */
+    bool AllocRingSlice(
+            DxvkPhysicalBufferSlice&  slice);
+    
+    /**
+     * \brief Allocates backing storage from the buffer
+     * 
+     * Used to move the buffer out of the uniform ring
+     * at the end of a frame, so that the ring buffer
+     * can be reused once the GPU is done with it.
+     * \returns The new backing buffer slice
+     */
+    DxvkPhysicalBufferSlice AllocBufferSlice();
+    
+    /**
+     * \brief Checks whether the buffer uses the uniform ring
+     * 
+     * \returns \c true if the most recently allocated
+     *          backing storage is a uniform ring slice
+     */
+    bool IsRingBacked() const {
+      return m_ringBacked;
+    }
+    
   private:
     
     const Com<D3D11Device>      m_device;
@@ -71,6 +114,8 @@ namespace dxvk {
     
     Rc<DxvkBuffer>              m_buffer;
     D3D11BufferInfo             m_bufferInfo;
+    bool                        m_useUniformRing = false;
+    bool                        m_ringBacked     = false;
     
     Rc<DxvkBuffer> CreateBuffer(
       const D3D11_BUFFER_DESC* pDesc) const;
@@ -78,6 +123,9 @@ namespace dxvk {
     VkMemoryPropertyFlags GetMemoryFlags(
       const D3D11_BUFFER_DESC* pDesc) const;
     
+    bool UseUniformRing(
+      const D3D11_BUFFER_DESC* pDesc) const;
+    
   };
   
 }
@@ -41,6 +41,11 @@ namespace dxvk {
   }
   
   
+  Rc<DxvkRecording> D3D11CommandList::CreateRecording() const {
+    return new DxvkRecording(m_chunks);
+  }
+  
+  
   void D3D11CommandList::EmitToCommandList(ID3D11CommandList* pCommandList) {
     auto cmdList = static_cast<D3D11CommandList*>(pCommandList);
     
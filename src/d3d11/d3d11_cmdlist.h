@@ -25,6 +25,8 @@ namespace dxvk {
     
     void AddChunk(Rc<DxvkCsChunk>&& Chunk);
     
+    Rc<DxvkRecording> CreateRecording() const;
+    
     void EmitToCommandList(
             ID3D11CommandList*  pCommandList);
     
@@ -10,11 +10,13 @@
 namespace dxvk {
   
   D3D11DeviceContext::D3D11DeviceContext(
-      D3D11Device*    pParent,
-      Rc<DxvkDevice>  Device)
+      D3D11Device*      pParent,
+      Rc<DxvkDevice>    Device,
+      DxvkCsChunkFlags  CsFlags)
   : m_parent  (pParent),
     m_device  (Device),
-    m_csChunk (new DxvkCsChunk()) {
+    m_csFlags (CsFlags),
+    m_csChunk (AllocCsChunk()) {
     // Create default state objects. We won't ever return them
     // to the application, but we'll use them to apply state.
     Com<ID3D11BlendState>         defaultBlendState;
@@ -701,6 +703,12 @@ namespace dxvk {
       if (size == 0)
         return;
       
+      // Small constant buffers are updated by renaming them to
+      // a slice of the uniform ring, just like a discarding map
+      if (size == bufferSlice.length()
+       && UpdateRingBuffer(bufferResource, pSrcData))
+        return;
+      
       if (((size == bufferSlice.length())
        && (bufferSlice.buffer()->memFlags() & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))) {
         D3D11_MAPPED_SUBRESOURCE mappedSr;
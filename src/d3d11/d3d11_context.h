@@ -16,8 +16,9 @@ namespace dxvk {
   public:
     
     D3D11DeviceContext(
-      D3D11Device*    pParent,
-      Rc<DxvkDevice>  Device);
+      D3D11Device*      pParent,
+      Rc<DxvkDevice>    Device,
+      DxvkCsChunkFlags  CsFlags);
     ~D3D11DeviceContext();
     
     HRESULT STDMETHODCALLTYPE QueryInterface(
@@ -517,6 +518,8 @@ namespace dxvk {
     D3D11Device* const m_parent;
     
     Rc<DxvkDevice>              m_device;
+    
+    DxvkCsChunkFlags            m_csFlags;
     Rc<DxvkCsChunk>             m_csChunk;
     Rc<DxvkDataBuffer>          m_updateBuffer;
     
@@ -644,7 +647,7 @@ namespace dxvk {
       if (!m_csChunk->push(command)) {
         EmitCsChunk(std::move(m_csChunk));
         
-        m_csChunk = new DxvkCsChunk();
+        m_csChunk = AllocCsChunk();
         m_csChunk->push(command);
       }
     }
@@ -652,12 +655,20 @@ namespace dxvk {
     void FlushCsChunk() {
       if (m_csChunk->commandCount() != 0) {
         EmitCsChunk(std::move(m_csChunk));
-        m_csChunk = new DxvkCsChunk();
+        m_csChunk = AllocCsChunk();
       }
     }
     
+    Rc<DxvkCsChunk> AllocCsChunk() {
+      return m_device->allocCsChunk(m_csFlags);
+    }
+    
     virtual void EmitCsChunk(Rc<DxvkCsChunk>&& chunk) = 0;
     
+    virtual bool UpdateRingBuffer(
+            D3D11Buffer*                      pBuffer,
+      const void*                             pData) = 0;
+    
   };
   
 }
@@ -6,7 +6,7 @@ namespace dxvk {
     D3D11Device*    pParent,
     Rc<DxvkDevice>  Device,
     UINT            ContextFlags)
-  : D3D11DeviceContext(pParent, Device),
+  : D3D11DeviceContext(pParent, Device, 0),
     m_contextFlags(ContextFlags),
     m_commandList (CreateCommandList()) {
     ClearState();
@@ -86,5 +86,15 @@ namespace dxvk {
   void D3D11DeferredContext::EmitCsChunk(Rc<DxvkCsChunk>&& chunk) {
     m_commandList->AddChunk(std::move(chunk));
   }
+  
+  
+  bool D3D11DeferredContext::UpdateRingBuffer(
+          D3D11Buffer*                      pBuffer,
+    const void*                             pData) {
+    // Buffers are moved out of the ring at the end of each
+    // frame on the immediate context. Command lists may be
+    // executed at any later point, so they cannot use it.
+    return false;
+  }
 
 }
\ No newline at end of file
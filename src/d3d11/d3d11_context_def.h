@@ -49,6 +49,10 @@ namespace dxvk {
     
     void EmitCsChunk(Rc<DxvkCsChunk>&& chunk) final;
     
+    bool UpdateRingBuffer(
+            D3D11Buffer*                      pBuffer,
+      const void*                             pData) final;
+    
   };
   
 }
\ No newline at end of file
@@ -8,8 +8,8 @@ namespace dxvk {
   D3D11ImmediateContext::D3D11ImmediateContext(
     D3D11Device*    pParent,
     Rc<DxvkDevice>  Device)
-  : D3D11DeviceContext(pParent, Device),
-    m_csThread(Device->createContext()) {
+  : D3D11DeviceContext(pParent, Device, DxvkCsChunkFlag::SingleUse),
+    m_csThread(Device, Device->createContext()) {
     
   }
   
@@ -47,6 +47,18 @@ namespace dxvk {
     if (m_csChunk->commandCount() != 0) {
       m_drawCount = 0;
       
+      // All initialization commands have been submitted
+      // at this point, so buffers created up until now
+      // can be safely moved to a different location.
+      if (m_device->hasOption(DxvkOption::DefragmentMemory)) {
+        EmitCs([
+          cDevice = m_device,
+          cSerial = m_device->getDefragSerial()
+        ] (DxvkContext* ctx) {
+          cDevice->defragmentMemory(ctx, cSerial);
+        });
+      }
+      
       // Add commands to flush the threaded
       // context, then flush the command list
       EmitCs([dev = m_device] (DxvkContext* ctx) {
@@ -66,14 +78,37 @@ namespace dxvk {
   void STDMETHODCALLTYPE D3D11ImmediateContext::ExecuteCommandList(
           ID3D11CommandList*  pCommandList,
           BOOL                RestoreContextState) {
-    FlushCsChunk();
+    auto commandList = static_cast<D3D11CommandList*>(pCommandList);
     
-    static_cast<D3D11CommandList*>(pCommandList)->EmitToCsThread(&m_csThread);
+    if (m_parent->GetCommandListRecorder() != nullptr) {
+      // Command lists passed to consecutive calls are recorded
+      // in parallel. Only the state reset commands emitted by
+      // the previous call may precede this one, since those
+      // are executed after the recordings have been submitted.
+      if (m_recordings.size() == 0
+       || m_recordingChunk    != m_csChunk.ptr()
+       || m_recordingCmdCount != m_csChunk->commandCount())
+        FlushCsChunk();
+      
+      m_parent->FlushInitContext();
+      m_drawCount = 0;
+      
+      m_recordings.push_back(commandList->CreateRecording());
+    } else {
+      FlushCsChunk();
+      
+      commandList->EmitToCsThread(&m_csThread);
+    }
     
     if (RestoreContextState)
       RestoreState();
     else
       ClearState();
+    
+    if (m_recordings.size() != 0) {
+      m_recordingChunk    = m_csChunk.ptr();
+      m_recordingCmdCount = m_csChunk->commandCount();
+    }
   }
   
   
@@ -115,18 +150,11 @@ namespace dxvk {
         // Allocate a new backing slice for the buffer and set
         // it as the 'new' mapped slice. This assumes that the
         // only way to invalidate a buffer is by mapping it.
-        auto physicalSlice = buffer->allocPhysicalSlice();
-        physicalSlice.resource()->acquire();
+        const bool wasRingBacked = resource->IsRingBacked();
         
-        resource->GetBufferInfo()->mappedSlice = physicalSlice;
-        
-        EmitCs([
-          cBuffer        = buffer,
-          cPhysicalSlice = physicalSlice
-        ] (DxvkContext* ctx) {
-          ctx->invalidateBuffer(cBuffer, cPhysicalSlice);
-          cPhysicalSlice.resource()->release();
-        });
+        InvalidateBuffer(resource,
+          resource->AllocPhysicalSlice(),
+          wasRingBacked);
       } else if (MapType != D3D11_MAP_WRITE_NO_OVERWRITE) {
         if (!WaitForResource(buffer->resource(), MapFlags))
           return DXGI_ERROR_WAS_STILL_DRAWING;
@@ -228,7 +256,13 @@ namespace dxvk {
             });
           }
           
-          if (!WaitForResource(textureInfo->imageBuffer->resource(), MapFlags))
+          // If we had to copy the image, we must not return early
+          // since a subsequent call would just issue another copy
+          const UINT waitFlags = copyExistingData
+            ? MapFlags & ~D3D11_MAP_FLAG_DO_NOT_WAIT
+            : MapFlags;
+          
+          if (!WaitForResource(textureInfo->imageBuffer->resource(), waitFlags))
             return DXGI_ERROR_WAS_STILL_DRAWING;
           
           physicalSlice = textureInfo->imageBuffer->slice();
@@ -280,6 +314,32 @@ namespace dxvk {
   }
   
   
+  void D3D11ImmediateContext::ReleaseRingBuffers() {
+    // Move buffers that still use a uniform ring slice back
+    // to their own storage. Otherwise, a buffer that is not
+    // discarded again would keep its ring buffer alive.
+    for (const auto& buffer : m_ringBuffers) {
+      if (!buffer->IsRingBacked())
+        continue;
+      
+      const DxvkPhysicalBufferSlice physicalSlice = buffer->AllocBufferSlice();
+      physicalSlice.resource()->acquire();
+      
+      buffer->GetBufferInfo()->mappedSlice = physicalSlice;
+      
+      EmitCs([
+        cBuffer        = buffer->GetBufferSlice().buffer(),
+        cPhysicalSlice = physicalSlice
+      ] (DxvkContext* ctx) {
+        ctx->relocateBuffer(cBuffer, cPhysicalSlice);
+        cPhysicalSlice.resource()->release();
+      });
+    }
+    
+    m_ringBuffers.clear();
+  }
+  
+  
   void D3D11ImmediateContext::SynchronizeCsThread() {
     // Dispatch current chunk so that all commands
     // recorded prior to this function will be run
@@ -304,16 +364,102 @@ namespace dxvk {
     SynchronizeCsThread();
     
     if (Resource->isInUse()) {
-      // TODO implement properly in DxvkDevice
-      while (Resource->isInUse())
-        std::this_thread::yield();
+      if (MapFlags & D3D11_MAP_FLAG_DO_NOT_WAIT)
+        return false;
+      
+      m_device->waitForResource(Resource);
     }
     
     return true;
   }
   
   
+  void D3D11ImmediateContext::FlushRecordings() {
+    // The CS thread waits for the recordings to complete, so
+    // that buffers cannot be renamed while worker threads are
+    // resolving them. Submitting the current command list first
+    // and the recorded ones in order preserves the order of
+    // operations on the GPU, and any resources tracked by the
+    // recorded command lists are released once they complete.
+    Rc<DxvkCsChunk> chunk = AllocCsChunk();
+    
+    auto command = [
+      cDevice     = m_device,
+      cRecorder   = m_parent->GetCommandListRecorder(),
+      cRecordings = std::move(m_recordings)
+    ] (DxvkContext* ctx) {
+      cDevice->submitCommandList(
+        ctx->endRecording(),
+        nullptr, nullptr);
+      
+      for (const auto& recording : cRecordings)
+        cRecorder->record(recording);
+      
+      for (const auto& recording : cRecordings) {
+        cDevice->submitCommandList(
+          recording->takeCommandList(),
+          nullptr, nullptr);
+      }
+      
+      ctx->beginRecording(
+        cDevice->createCommandList());
+    };
+    
+    chunk->push(command);
+    m_recordings.clear();
+    
+    m_csThread.dispatchChunk(std::move(chunk));
+  }
+  
+  
+  void D3D11ImmediateContext::InvalidateBuffer(
+          D3D11Buffer*                      pBuffer,
+    const DxvkPhysicalBufferSlice&          PhysicalSlice,
+          bool                              WasRingBacked) {
+    PhysicalSlice.resource()->acquire();
+    
+    pBuffer->GetBufferInfo()->mappedSlice = PhysicalSlice;
+    
+    EmitCs([
+      cBuffer        = pBuffer->GetBufferSlice().buffer(),
+      cPhysicalSlice = PhysicalSlice
+    ] (DxvkContext* ctx) {
+      ctx->invalidateBuffer(cBuffer, cPhysicalSlice);
+      cPhysicalSlice.resource()->release();
+    });
+    
+    // Remember buffers that were moved to the uniform
+    // ring so that they can be moved back at the end
+    // of the frame, see ReleaseRingBuffers
+    if (!WasRingBacked && pBuffer->IsRingBacked())
+      m_ringBuffers.push_back(pBuffer);
+  }
+  
+  
+  bool D3D11ImmediateContext::UpdateRingBuffer(
+          D3D11Buffer*                      pBuffer,
+    const void*                             pData) {
+    const bool wasRingBacked = pBuffer->IsRingBacked();
+    
+    DxvkPhysicalBufferSlice physicalSlice;
+    
+    if (!pBuffer->AllocRingSlice(physicalSlice))
+      return false;
+    
+    std::memcpy(physicalSlice.mapPtr(0), pData, physicalSlice.length());
+    
+    InvalidateBuffer(pBuffer, physicalSlice, wasRingBacked);
+    return true;
+  }
+  
+  
   void D3D11ImmediateContext::EmitCsChunk(Rc<DxvkCsChunk>&& chunk) {
+    // Command lists executed before this chunk
+    // was recorded must be submitted before it
+    if (m_recordings.size() != 0)
+      FlushRecordings();
+    
+    m_recordingChunk = nullptr;
     m_csThread.dispatchChunk(std::move(chunk));
   }
   
@@ -44,18 +44,37 @@ namespace dxvk {
     
     void SynchronizeCsThread();
     
+    void ReleaseRingBuffers();
+    
   private:
     
     DxvkCsThread m_csThread;
     
+    std::vector<Rc<DxvkRecording>> m_recordings;
+    const DxvkCsChunk*             m_recordingChunk    = nullptr;
+    size_t                         m_recordingCmdCount = 0;
+    
+    std::vector<Com<D3D11Buffer>>  m_ringBuffers;
+    
     void SynchronizeDevice();
     
     bool WaitForResource(
       const Rc<DxvkResource>&                 Resource,
             UINT                              MapFlags);
     
+    void FlushRecordings();
+    
+    void InvalidateBuffer(
+            D3D11Buffer*                      pBuffer,
+      const DxvkPhysicalBufferSlice&          PhysicalSlice,
+            bool                              WasRingBacked);
+    
     void EmitCsChunk(Rc<DxvkCsChunk>&& chunk) final;
     
+    bool UpdateRingBuffer(
+            D3D11Buffer*                      pBuffer,
+      const void*                             pData) final;
+    
   };
   
 }
\ No newline at end of file
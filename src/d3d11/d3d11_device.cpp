@@ -38,6 +38,9 @@ namespace dxvk {
     
     m_context = new D3D11ImmediateContext(this, m_dxvkDevice);
     
+    if (m_dxvkDevice->hasOption(DxvkOption::ParallelCommandLists))
+      m_cmdListRecorder = new DxvkRecorder(m_dxvkDevice);
+    
     m_resourceInitContext = m_dxvkDevice->createContext();
     m_resourceInitContext->beginRecording(
       m_dxvkDevice->createCommandList());
@@ -1410,6 +1413,9 @@ namespace dxvk {
   
   
   void D3D11Device::FlushInitContext() {
+    if (m_dxvkDevice->hasOption(DxvkOption::AsyncTransfer))
+      m_dxvkDevice->flushUploads();
+    
     LockResourceInitContext();
     if (m_resourceInitCommands != 0)
       SubmitResourceInitCommands();
@@ -1534,15 +1540,33 @@ namespace dxvk {
       = pBuffer->GetBufferSlice();
     
     if (pInitialData != nullptr && pInitialData->pSysMem != nullptr) {
-      LockResourceInitContext();
-      
-      m_resourceInitContext->updateBuffer(
-        bufferSlice.buffer(),
-        bufferSlice.offset(),
-        bufferSlice.length(),
-        pInitialData->pSysMem);
-      
-      UnlockResourceInitContext(1);
+      // Copy the data into staging memory on the calling thread,
+      // so that threads creating resources in parallel only need
+      // to synchronize in order to record the actual copy.
+      const DxvkBufferSlice stagingSlice
+        = m_dxvkDevice->allocStagingData(bufferSlice.length());
+      
+      std::memcpy(stagingSlice.mapPtr(0),
+        pInitialData->pSysMem, bufferSlice.length());
+      
+      if (m_dxvkDevice->hasOption(DxvkOption::AsyncTransfer)) {
+        m_dxvkDevice->uploadBuffer(
+          bufferSlice.buffer(),
+          bufferSlice.offset(),
+          bufferSlice.length(),
+          stagingSlice);
+      } else {
+        LockResourceInitContext();
+        
+        m_resourceInitContext->copyBuffer(
+          bufferSlice.buffer(),
+          bufferSlice.offset(),
+          stagingSlice.buffer(),
+          stagingSlice.offset(),
+          bufferSlice.length());
+        
+        UnlockResourceInitContext(1);
+      }
     }
   }
   
@@ -1553,8 +1577,6 @@ namespace dxvk {
     const DxvkFormatInfo* formatInfo = imageFormatInfo(image->info().format);
     
     if (pInitialData != nullptr && pInitialData->pSysMem != nullptr) {
-      LockResourceInitContext();
-      
       // pInitialData is an array that stores an entry for
       // every single subresource. Since we will define all
       // subresources, this counts as initialization.
@@ -1564,27 +1586,67 @@ namespace dxvk {
       subresourceLayers.baseArrayLayer = 0;
       subresourceLayers.layerCount     = 1;
       
+      const uint32_t subresourceCount =
+        image->info().numLayers * image->info().mipLevels;
+      
+      // Pack all subresources into staging memory before taking
+      // any locks, so that textures can be created in parallel.
+      std::vector<DxvkBufferSlice> stagingSlices;
+      stagingSlices.reserve(subresourceCount);
+      
       for (uint32_t layer = 0; layer < image->info().numLayers; layer++) {
         for (uint32_t level = 0; level < image->info().mipLevels; level++) {
-          subresourceLayers.baseArrayLayer = layer;
-          subresourceLayers.mipLevel       = level;
-          
           const uint32_t id = D3D11CalcSubresource(
             level, layer, image->info().mipLevels);
           
-          m_resourceInitContext->updateImage(
-            image, subresourceLayers,
-            VkOffset3D { 0, 0, 0 },
-            image->mipLevelExtent(level),
-            pInitialData[id].pSysMem,
+          const VkExtent3D elementCount = util::computeBlockCount(
+            image->mipLevelExtent(level), formatInfo->blockSize);
+          
+          const DxvkBufferSlice stagingSlice = m_dxvkDevice->allocStagingData(
+            formatInfo->elementSize * util::flattenImageExtent(elementCount));
+          
+          util::packImageData(
+            reinterpret_cast<char*>(stagingSlice.mapPtr(0)),
+            reinterpret_cast<const char*>(pInitialData[id].pSysMem),
+            elementCount, formatInfo->elementSize,
             pInitialData[id].SysMemPitch,
             pInitialData[id].SysMemSlicePitch);
+          
+          stagingSlices.push_back(stagingSlice);
         }
       }
       
-      const uint32_t subresourceCount =
-        image->info().numLayers * image->info().mipLevels;
-      UnlockResourceInitContext(subresourceCount);
+      const bool asyncTransfer = m_dxvkDevice->hasOption(DxvkOption::AsyncTransfer);
+      
+      if (!asyncTransfer)
+        LockResourceInitContext();
+      
+      for (uint32_t layer = 0; layer < image->info().numLayers; layer++) {
+        for (uint32_t level = 0; level < image->info().mipLevels; level++) {
+          subresourceLayers.baseArrayLayer = layer;
+          subresourceLayers.mipLevel       = level;
+          
+          const DxvkBufferSlice& stagingSlice =
+            stagingSlices[layer * image->info().mipLevels + level];
+          
+          if (asyncTransfer) {
+            m_dxvkDevice->uploadImage(
+              image, subresourceLayers,
+              stagingSlice);
+          } else {
+            m_resourceInitContext->copyBufferToImage(
+              image, subresourceLayers,
+              VkOffset3D { 0, 0, 0 },
+              image->mipLevelExtent(level),
+              stagingSlice.buffer(),
+              stagingSlice.offset(),
+              VkExtent2D { 0, 0 });
+          }
+        }
+      }
+      
+      if (!asyncTransfer)
+        UnlockResourceInitContext(subresourceCount);
     } else {
       LockResourceInitContext();
       
@@ -236,6 +236,10 @@ namespace dxvk {
       return m_dxvkDevice;
     }
     
+    Rc<DxvkRecorder> GetCommandListRecorder() {
+      return m_cmdListRecorder;
+    }
+    
     DxvkBufferSlice AllocateCounterSlice();
     
     void FreeCounterSlice(const DxvkBufferSlice& Slice);
@@ -272,6 +276,8 @@ namespace dxvk {
     
     D3D11ImmediateContext*          m_context = nullptr;
     
+    Rc<DxvkRecorder>                m_cmdListRecorder;
+    
     std::mutex                      m_counterMutex;
     std::vector<uint32_t>           m_counterSlices;
     Rc<DxvkBuffer>                  m_counterBuffer;
@@ -64,6 +64,7 @@ namespace dxvk {
     // The presentation code is run from the main rendering thread
     // rather than the command stream thread, so we synchronize.
     auto immediateContext = static_cast<D3D11ImmediateContext*>(deviceContext.ptr());
+    immediateContext->ReleaseRingBuffers();
     immediateContext->Flush();
     immediateContext->SynchronizeCsThread();
     return S_OK;
@@ -107,6 +107,20 @@ namespace dxvk {
   }
   
   
+  uint32_t DxvkAdapter::transferQueueFamily() const {
+    const VkQueueFlags mask = VK_QUEUE_GRAPHICS_BIT
+                            | VK_QUEUE_COMPUTE_BIT
+                            | VK_QUEUE_TRANSFER_BIT;
+    
+    for (uint32_t i = 0; i < m_queueFamilies.size(); i++) {
+      if ((m_queueFamilies[i].queueFlags & mask) == VK_QUEUE_TRANSFER_BIT)
+        return i;
+    }
+    
+    return this->graphicsQueueFamily();
+  }
+  
+  
   bool DxvkAdapter::checkFeatureSupport(
     const VkPhysicalDeviceFeatures& required) const {
     const VkPhysicalDeviceFeatures supported = this->features();
@@ -187,6 +201,7 @@ namespace dxvk {
     
     const uint32_t gIndex = this->graphicsQueueFamily();
     const uint32_t pIndex = this->presentQueueFamily();
+    const uint32_t tIndex = this->transferQueueFamily();
     
     VkDeviceQueueCreateInfo graphicsQueue;
     graphicsQueue.sType             = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -203,6 +218,14 @@ namespace dxvk {
       queueInfos.push_back(presentQueue);
     }
     
+    // The transfer queue is only used if async
+    // transfers are enabled, but creating it is cheap
+    if (tIndex != gIndex && tIndex != pIndex) {
+      VkDeviceQueueCreateInfo transferQueue = graphicsQueue;
+      transferQueue.queueFamilyIndex        = tIndex;
+      queueInfos.push_back(transferQueue);
+    }
+    
     VkDeviceCreateInfo info;
     info.sType                      = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
     info.pNext                      = nullptr;
@@ -119,6 +119,18 @@ namespace dxvk {
      */
     uint32_t presentQueueFamily() const;
     
+    /**
+     * \brief Transfer queue family index
+     * 
+     * Returns a queue family which only supports transfer
+     * operations if the adapter exposes one, or the graphics
+     * queue family otherwise. Dedicated transfer queues are
+     * usually backed by DMA engines that run independently
+     * of the graphics engine.
+     * \returns Transfer queue family index
+     */
+    uint32_t transferQueueFamily() const;
+    
     /**
      * \brief Tests whether all required features are supported
      * 
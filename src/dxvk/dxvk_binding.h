@@ -84,6 +84,63 @@ namespace dxvk {
   };
   
   
+  /**
+   * \brief Resource slot mask
+   * 
+   * Stores one bit per resource slot. The context uses
+   * this to remember which slots have been modified since
+   * the descriptors for a pipeline were last updated.
+   */
+  class DxvkResourceSlotMask {
+    constexpr static uint32_t BitCount = 64;
+    constexpr static uint32_t IntCount = (MaxNumResourceSlots + BitCount - 1) / BitCount;
+  public:
+    
+    /**
+     * \brief Tests whether a slot is set
+     * 
+     * \param [in] slot The resource slot
+     * \returns \c true if the slot is set
+     */
+    bool test(uint32_t slot) const {
+      const uint32_t intId = slot / BitCount;
+      const uint32_t bitId = slot % BitCount;
+      return (m_slots[intId] & (1ull << bitId)) != 0;
+    }
+    
+    /**
+     * \brief Sets a single slot
+     * \param [in] slot The resource slot
+     */
+    void set(uint32_t slot) {
+      const uint32_t intId = slot / BitCount;
+      const uint32_t bitId = slot % BitCount;
+      m_slots[intId] |= 1ull << bitId;
+    }
+    
+    /**
+     * \brief Sets all slots
+     */
+    void setAll() {
+      for (uint32_t i = 0; i < IntCount; i++)
+        m_slots[i] = ~0ull;
+    }
+    
+    /**
+     * \brief Clears all slots
+     */
+    void clear() {
+      for (uint32_t i = 0; i < IntCount; i++)
+        m_slots[i] = 0;
+    }
+    
+  private:
+    
+    uint64_t m_slots[IntCount] = { };
+    
+  };
+  
+  
   /**
    * \brief Bound shader resources
    * 
@@ -17,7 +17,20 @@ namespace dxvk {
     
     // Initialize a single backing bufer with one slice
     m_physBuffers[0] = this->allocPhysicalBuffer(1);
-    m_physSlice      = this->allocPhysicalSlice();
+    m_physSlice      = this->nextPhysicalSlice();
+    
+    // Buffers that are never mapped by the host never get
+    // a second backing slice, so they can be safely moved
+    // to a different location in device memory.
+    if ((memoryType & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)
+     && !(memoryType & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT))
+      m_relocatable = m_device->registerBuffer(this);
+  }
+  
+  
+  DxvkBuffer::~DxvkBuffer() {
+    if (m_relocatable)
+      m_device->unregisterBuffer(this);
   }
   
   
@@ -28,39 +41,123 @@ namespace dxvk {
   
   
   DxvkPhysicalBufferSlice DxvkBuffer::allocPhysicalSlice() {
-    if (m_physSliceId >= m_physSliceCount) {
-      m_physBufferId = (m_physBufferId + 1) % m_physBuffers.size();
-      m_physSliceId  = 0;
-      
-      if (m_physBuffers[m_physBufferId] == nullptr) {
-        // Make sure that all buffers have the same size. If we don't do this,
-        // one of the physical buffers may grow indefinitely while the others
-        // remain small, depending on the usage pattern of the application.
-        m_physBuffers[m_physBufferId] = this->allocPhysicalBuffer(m_physSliceCount);
-      } else if (m_physBuffers[m_physBufferId]->isInUse()) {
-        // Allocate a new physical buffer if the current one is still in use.
-        // This also indicates that the buffer gets updated frequently, so we
-        // will double the size of the physical buffers to accomodate for it.
-        if (m_physBufferId == 0) {
-          std::fill(m_physBuffers.begin(), m_physBuffers.end(), nullptr);
-          m_physSliceCount *= 2;
-        }
+    this->updateDiscardRate();
+    
+    m_discardCount += 1;
+    m_discardPeak   = std::max(m_discardPeak, m_discardCount);
+    
+    bool realloc = false;
+    
+    if (m_physSliceId >= m_physSliceCount)
+      realloc = this->swapPhysicalBuffer();
+    
+    m_device->countBufferDiscards(1, realloc ? 1 : 0);
+    return this->nextPhysicalSlice();
+  }
+  
+  
+  bool DxvkBuffer::needsRelocation() const {
+    return m_relocatable
+        && m_physBuffers[0]->isEvacuating();
+  }
+  
+  
+  DxvkPhysicalBufferSlice DxvkBuffer::relocate() {
+    m_physBuffers[0] = this->allocPhysicalBuffer(1);
+    m_physBufferId   = 0;
+    m_physSliceId    = 0;
+    return this->nextPhysicalSlice();
+  }
+  
+  
+  Rc<DxvkPhysicalBuffer> DxvkBuffer::allocPhysicalBuffer(VkDeviceSize sliceCount) const {
+    DxvkBufferCreateInfo createInfo = m_info;
+    createInfo.size = sliceCount * m_physSliceStride;
+    
+    return m_device->allocPhysicalBuffer(createInfo, m_memFlags);
+  }
+  
+  
+  bool DxvkBuffer::swapPhysicalBuffer() {
+    m_physBufferId = (m_physBufferId + 1) % m_physBuffers.size();
+    m_physSliceId  = 0;
+    
+    if (m_physBuffers[m_physBufferId] == nullptr) {
+      // Make sure that all buffers have the same size. If we don't do this,
+      // one of the physical buffers may grow indefinitely while the others
+      // remain small, depending on the usage pattern of the application.
+      m_physBuffers[m_physBufferId] = this->allocPhysicalBuffer(m_physSliceCount);
+      return true;
+    } else if (m_physBuffers[m_physBufferId]->isInUse()) {
+      // Allocate a new physical buffer if the current one is still in use.
+      // This also indicates that the buffer gets updated frequently, so we
+      // will grow the pool so that it can hold at least one frame's worth
+      // of discards, and at least double its size to limit reallocations.
+      if (m_physBufferId == 0) {
+        std::fill(m_physBuffers.begin(), m_physBuffers.end(), nullptr);
+        m_physSliceCount = std::max(m_physSliceCount * 2,
+          this->getPoolSize(m_discardCount));
         
-        m_physBuffers[m_physBufferId] = this->allocPhysicalBuffer(m_physSliceCount);
+        m_discardPeak = 0;
+        m_quietFrames = 0;
       }
+      
+      m_physBuffers[m_physBufferId] = this->allocPhysicalBuffer(m_physSliceCount);
+      return true;
+    } else if (m_physBufferId == 0 && m_quietFrames >= PoolShrinkFrames) {
+      // The buffer has not been discarded much in a while, so
+      // we can release most of the memory. The second buffer
+      // will be allocated again with the new size when needed.
+      std::fill(m_physBuffers.begin(), m_physBuffers.end(), nullptr);
+      m_physSliceCount = this->getPoolSize(m_discardPeak);
+      
+      m_physBuffers[m_physBufferId] = this->allocPhysicalBuffer(m_physSliceCount);
+      
+      m_discardPeak = 0;
+      m_quietFrames = 0;
+      return true;
     }
     
+    return false;
+  }
+  
+  
+  DxvkPhysicalBufferSlice DxvkBuffer::nextPhysicalSlice() {
     return m_physBuffers[m_physBufferId]->slice(
       m_physSliceStride * m_physSliceId++,
       m_physSliceLength);
   }
   
   
-  Rc<DxvkPhysicalBuffer> DxvkBuffer::allocPhysicalBuffer(VkDeviceSize sliceCount) const {
-    DxvkBufferCreateInfo createInfo = m_info;
-    createInfo.size = sliceCount * m_physSliceStride;
+  void DxvkBuffer::updateDiscardRate() {
+    const uint64_t frameId = m_device->getCurrentFrameId();
     
-    return m_device->allocPhysicalBuffer(createInfo, m_memFlags);
+    if (m_discardFrameId == frameId)
+      return;
+    
+    // A frame is considered quiet if less than a quarter of
+    // the pool was used. Frames in which the buffer was not
+    // discarded at all are quiet as well.
+    if (2 * m_discardCount <= m_physSliceCount) {
+      m_quietFrames += uint32_t(std::min<uint64_t>(
+        frameId - m_discardFrameId, PoolShrinkFrames));
+    } else {
+      m_discardPeak = 0;
+      m_quietFrames = 0;
+    }
+    
+    m_discardFrameId = frameId;
+    m_discardCount   = 0;
+  }
+  
+  
+  VkDeviceSize DxvkBuffer::getPoolSize(uint32_t discardCount) const {
+    VkDeviceSize sliceCount = 1;
+    
+    while (sliceCount < discardCount)
+      sliceCount *= 2;
+    
+    return sliceCount;
   }
   
   
@@ -81,9 +178,18 @@ namespace dxvk {
   
   
   void DxvkBufferView::updateView() {
-    if (m_revision != m_buffer->m_revision) {
-      m_physView = this->createView();
-      m_revision = m_buffer->m_revision;
+    // Command list recorder threads may use the
+    // same view concurrently, but the buffer is
+    // never renamed while they are running.
+    const uint32_t revision = m_buffer->m_revision;
+    
+    if (m_revision.load(std::memory_order_acquire) != revision) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      
+      if (m_revision.load(std::memory_order_relaxed) != revision) {
+        m_physView = this->createView();
+        m_revision.store(revision, std::memory_order_release);
+      }
     }
   }
   
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 #include "dxvk_buffer_res.h"
 
 namespace dxvk {
@@ -20,6 +22,8 @@ namespace dxvk {
       const DxvkBufferCreateInfo& createInfo,
             VkMemoryPropertyFlags memoryType);
     
+    ~DxvkBuffer();
+    
     /**
      * \brief Buffer properties
      * \returns Buffer properties
@@ -113,6 +117,14 @@ namespace dxvk {
     /**
      * \brief Allocates new physical resource
      * 
+     * Returns the next slice from the buffer's renaming
+     * pool. The pool consists of two backing buffers which
+     * are used alternately. If the backing buffer that is
+     * about to be reused is still in use by the GPU, the
+     * pool grows according to the number of discards in
+     * the current frame. After a number of frames with
+     * only few discards, it shrinks again.
+     * 
      * This method must not be called from multiple threads
      * simultaneously, but it can be called in parallel with
      * \ref rename and other methods of this class.
@@ -120,13 +132,41 @@ namespace dxvk {
      */
     DxvkPhysicalBufferSlice allocPhysicalSlice();
     
+    /**
+     * \brief Checks whether the buffer needs to be moved
+     * 
+     * Buffers which are never mapped by the host only have
+     * one backing slice, which can be moved to a different
+     * memory location in order to defragment device memory.
+     * \returns \c true if the buffer can be relocated and
+     *          its memory is located in a chunk that is
+     *          being defragmented.
+     */
+    bool needsRelocation() const;
+    
+    /**
+     * \brief Allocates new backing storage for relocation
+     * 
+     * Replaces the physical buffer, but does not rename
+     * the buffer. Do not call this directly, this is called
+     * by the context's \c relocateBuffer method, which also
+     * copies the buffer contents to the new location.
+     * \returns The new backing buffer slice
+     */
+    DxvkPhysicalBufferSlice relocate();
+    
   private:
     
+    /// Number of frames with few discards after which
+    /// the renaming pool is allowed to shrink again
+    constexpr static uint32_t PoolShrinkFrames = 64;
+    
     DxvkDevice*             m_device;
     DxvkBufferCreateInfo    m_info;
     VkMemoryPropertyFlags   m_memFlags;
     DxvkPhysicalBufferSlice m_physSlice;
     uint32_t                m_revision = 0;
+    bool                    m_relocatable = false;
     
     // TODO maybe align this to a cache line in order
     // to avoid false sharing once CSMT is implemented
@@ -136,11 +176,25 @@ namespace dxvk {
     VkDeviceSize m_physSliceLength  = 0;
     VkDeviceSize m_physSliceStride  = 0;
     
+    uint64_t     m_discardFrameId   = 0;
+    uint32_t     m_discardCount     = 0;
+    uint32_t     m_discardPeak      = 0;
+    uint32_t     m_quietFrames      = 0;
+    
     std::array<Rc<DxvkPhysicalBuffer>, 2> m_physBuffers;
     
     Rc<DxvkPhysicalBuffer> allocPhysicalBuffer(
             VkDeviceSize    sliceCount) const;
     
+    DxvkPhysicalBufferSlice nextPhysicalSlice();
+    
+    bool swapPhysicalBuffer();
+    
+    void updateDiscardRate();
+    
+    VkDeviceSize getPoolSize(
+            uint32_t        discardCount) const;
+    
   };
   
   
@@ -354,7 +408,8 @@ namespace dxvk {
     Rc<DxvkBuffer>             m_buffer;
     Rc<DxvkPhysicalBufferView> m_physView;
     
-    uint32_t                   m_revision = 0;
+    std::mutex                 m_mutex;
+    std::atomic<uint32_t>      m_revision = { 0u };
     
     Rc<DxvkPhysicalBufferView> createView();
     
@@ -23,10 +23,52 @@ namespace dxvk {
           &info, nullptr, &m_handle) != VK_SUCCESS)
       throw DxvkError("DxvkPhysicalBuffer: Failed to create buffer");
     
-    VkMemoryRequirements memReq;
-    m_vkd->vkGetBufferMemoryRequirements(
-      m_vkd->device(), m_handle, &memReq);
-    m_memory = memAlloc.alloc(memReq, memFlags);
+    VkMemoryDedicatedRequirementsKHR dedicatedRequirements;
+    dedicatedRequirements.sType                       = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR;
+    dedicatedRequirements.pNext                       = nullptr;
+    dedicatedRequirements.prefersDedicatedAllocation  = VK_FALSE;
+    dedicatedRequirements.requiresDedicatedAllocation = VK_FALSE;
+    
+    VkMemoryRequirements2KHR memReq;
+    memReq.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR;
+    memReq.pNext = &dedicatedRequirements;
+    
+    if (memAlloc.supportsDedicatedAllocation()) {
+      VkBufferMemoryRequirementsInfo2KHR memReqInfo;
+      memReqInfo.sType  = VK_STRUCTURE_TYPE_BUFFER_MEMORY_REQUIREMENTS_INFO_2_KHR;
+      memReqInfo.pNext  = nullptr;
+      memReqInfo.buffer = m_handle;
+      
+      m_vkd->vkGetBufferMemoryRequirements2KHR(
+        m_vkd->device(), &memReqInfo, &memReq);
+    } else {
+      m_vkd->vkGetBufferMemoryRequirements(
+        m_vkd->device(), m_handle, &memReq.memoryRequirements);
+    }
+    
+    VkMemoryDedicatedAllocateInfoKHR dedMemoryAllocInfo;
+    dedMemoryAllocInfo.sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR;
+    dedMemoryAllocInfo.pNext  = nullptr;
+    dedMemoryAllocInfo.image  = VK_NULL_HANDLE;
+    dedMemoryAllocInfo.buffer = m_handle;
+    
+    // Staging and readback buffers are only accessed by
+    // transfer operations, so they are the first to go
+    // to system memory if VRAM runs low. Vertex, index
+    // and constant buffers are used in almost every draw.
+    const VkBufferUsageFlags transferUsage
+      = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+      | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+    
+    const bool isStaging = (memFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+      && !(createInfo.usage & ~transferUsage);
+    
+    const DxvkMemoryPriority priority = isStaging
+      ? DxvkMemoryPriority::Low
+      : DxvkMemoryPriority::Normal;
+    
+    m_memory = memAlloc.alloc(memReq.memoryRequirements,
+      dedicatedRequirements, dedMemoryAllocInfo, memFlags, priority);
     
     if (m_vkd->vkBindBufferMemory(m_vkd->device(),
           m_handle, m_memory.memory(), m_memory.offset()) != VK_SUCCESS)
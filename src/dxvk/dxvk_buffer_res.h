@@ -89,6 +89,16 @@ namespace dxvk {
       return m_memory.mapPtr(offset);
     }
     
+    /**
+     * \brief Checks whether the buffer should be moved
+     * 
+     * \returns \c true if the buffer memory is located
+     *          in a chunk that is being defragmented
+     */
+    bool isEvacuating() const {
+      return m_memory.isEvacuating();
+    }
+    
     /**
      * \brief Retrieves a physical buffer slice
      * 
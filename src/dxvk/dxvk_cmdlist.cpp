@@ -1,4 +1,5 @@
 #include "dxvk_cmdlist.h"
+#include "dxvk_device.h"
 
 namespace dxvk {
     
@@ -6,7 +7,8 @@ namespace dxvk {
     const Rc<vk::DeviceFn>& vkd,
           DxvkDevice*       device,
           uint32_t          queueFamily)
-  : m_vkd(vkd), m_descAlloc(vkd), m_stagingAlloc(device) {
+  : m_vkd(vkd), m_device(device), m_queueFamily(queueFamily),
+    m_descAlloc(vkd), m_stagingAlloc(device) {
     VkCommandPoolCreateInfo poolInfo;
     poolInfo.sType            = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
     poolInfo.pNext            = nullptr;
@@ -84,6 +86,17 @@ namespace dxvk {
   void DxvkCommandList::reset() {
     m_queryTracker.reset();
     m_stagingAlloc.reset();
+    
+    // Cached descriptor sets are invalidated when
+    // the pools get reset, so reset both together
+    const DxvkStatCounters descStats = m_descCache.getStatCounters();
+    const uint64_t descHits   = descStats.getCtr(DxvkStatCounter::DescSetCacheHits);
+    const uint64_t descMisses = descStats.getCtr(DxvkStatCounter::DescSetCacheMisses);
+    
+    if (descHits + descMisses != 0)
+      m_device->countDescriptorSets(descHits, descMisses);
+    
+    m_descCache.reset();
     m_descAlloc.reset();
     m_resources.reset();
   }
@@ -32,6 +32,17 @@ namespace dxvk {
             uint32_t          queueFamily);
     ~DxvkCommandList();
     
+    /**
+     * \brief Queue family index
+     * 
+     * The command list can only be submitted to
+     * queues which belong to this queue family.
+     * \returns Queue family index
+     */
+    uint32_t queueFamily() const {
+      return m_queueFamily;
+    }
+    
     /**
      * \brief Submits command list
      * 
@@ -134,6 +145,23 @@ namespace dxvk {
     }
     
     
+    VkDescriptorSet lookupDescriptorSet(
+      const DxvkPipelineLayout*     layout,
+      const DxvkDescriptorInfo*     infos,
+            size_t                  hash) {
+      return m_descCache.lookup(layout, infos, hash);
+    }
+    
+    
+    void cacheDescriptorSet(
+      const DxvkPipelineLayout*     layout,
+      const DxvkDescriptorInfo*     infos,
+            size_t                  hash,
+            VkDescriptorSet         set) {
+      m_descCache.insert(layout, infos, hash, set);
+    }
+    
+    
     void updateDescriptorSet(
             uint32_t                descriptorCount,
       const VkWriteDescriptorSet*   descriptorWrites) {
@@ -142,6 +170,15 @@ namespace dxvk {
     }
     
     
+    void updateDescriptorSetWithTemplate(
+            VkDescriptorSet               descriptorSet,
+            VkDescriptorUpdateTemplateKHR descriptorTemplate,
+      const void*                         data) {
+      m_vkd->vkUpdateDescriptorSetWithTemplateKHR(m_vkd->device(),
+        descriptorSet, descriptorTemplate, data);
+    }
+    
+    
     void cmdBeginQuery(
             VkQueryPool             queryPool,
             uint32_t                query,
@@ -162,10 +199,12 @@ namespace dxvk {
     void cmdBindDescriptorSet(
           VkPipelineBindPoint       pipeline,
           VkPipelineLayout          pipelineLayout,
-          VkDescriptorSet           descriptorSet) {
+          VkDescriptorSet           descriptorSet,
+          uint32_t                  dynamicOffsetCount,
+    const uint32_t*                 pDynamicOffsets) {
       m_vkd->vkCmdBindDescriptorSets(m_buffer,
         pipeline, pipelineLayout, 0, 1,
-        &descriptorSet, 0, nullptr);
+        &descriptorSet, dynamicOffsetCount, pDynamicOffsets);
     }
     
     
@@ -498,16 +537,19 @@ namespace dxvk {
     
   private:
     
-    Rc<vk::DeviceFn>    m_vkd;
+    Rc<vk::DeviceFn>       m_vkd;
+    DxvkDevice*            m_device;
+    uint32_t               m_queueFamily;
     
-    VkCommandPool       m_pool;
-    VkCommandBuffer     m_buffer;
+    VkCommandPool          m_pool;
+    VkCommandBuffer        m_buffer;
     
-    DxvkLifetimeTracker m_resources;
-    DxvkDescriptorAlloc m_descAlloc;
-    DxvkStagingAlloc    m_stagingAlloc;
-    DxvkQueryTracker    m_queryTracker;
-    DxvkEventTracker    m_eventTracker;
+    DxvkLifetimeTracker    m_resources;
+    DxvkDescriptorAlloc    m_descAlloc;
+    DxvkDescriptorSetCache m_descCache;
+    DxvkStagingAlloc       m_stagingAlloc;
+    DxvkQueryTracker       m_queryTracker;
+    DxvkEventTracker       m_eventTracker;
     
   };
   
@@ -24,9 +24,13 @@ namespace dxvk {
     DxvkDescriptorSlotMapping slotMapping;
     cs->defineResourceSlots(slotMapping);
     
+    slotMapping.makeDescriptorsDynamic(
+      device->properties().limits.maxDescriptorSetUniformBuffersDynamic);
+    
     m_layout = new DxvkPipelineLayout(m_vkd,
       slotMapping.bindingCount(),
-      slotMapping.bindingInfos());
+      slotMapping.bindingInfos(),
+      device->extensions().khrDescriptorUpdateTemplate.enabled());
     
     m_cs = cs->createShaderModule(m_vkd, slotMapping);
     
@@ -16,9 +16,9 @@ namespace dxvk {
       m_descWrites[i].dstArrayElement  = 0;
       m_descWrites[i].descriptorCount  = 1;
       m_descWrites[i].descriptorType   = VkDescriptorType(0);
-      m_descWrites[i].pImageInfo       = &m_descInfos[i].image;
-      m_descWrites[i].pBufferInfo      = &m_descInfos[i].buffer;
-      m_descWrites[i].pTexelBufferView = &m_descInfos[i].texelBuffer;
+      m_descWrites[i].pImageInfo       = nullptr;
+      m_descWrites[i].pBufferInfo      = nullptr;
+      m_descWrites[i].pTexelBufferView = nullptr;
     }
   }
   
@@ -48,6 +48,11 @@ namespace dxvk {
       DxvkContextFlag::CpDirtyPipelineState,
       DxvkContextFlag::CpDirtyResources);
     
+    // Resources must be tracked by the new command list,
+    // so all descriptors have to be resolved again.
+    m_state.gp.descriptors.dirtySlots.setAll();
+    m_state.cp.descriptors.dirtySlots.setAll();
+    
     // Restart queries that were active during
     // the last command buffer submission.
     this->beginActiveQueries();
@@ -128,6 +133,9 @@ namespace dxvk {
       m_rc[slot].bufferView  = nullptr;
       m_rc[slot].bufferSlice = buffer;
       
+      m_state.gp.descriptors.dirtySlots.set(slot);
+      m_state.cp.descriptors.dirtySlots.set(slot);
+      
       m_flags.set(
         DxvkContextFlag::CpDirtyResources,
         DxvkContextFlag::GpDirtyResources);
@@ -146,6 +154,9 @@ namespace dxvk {
       m_rc[slot].bufferView  = bufferView;
       m_rc[slot].bufferSlice = DxvkBufferSlice();
       
+      m_state.gp.descriptors.dirtySlots.set(slot);
+      m_state.cp.descriptors.dirtySlots.set(slot);
+      
       m_flags.set(
         DxvkContextFlag::CpDirtyResources,
         DxvkContextFlag::GpDirtyResources);
@@ -162,6 +173,9 @@ namespace dxvk {
       m_rc[slot].bufferView  = nullptr;
       m_rc[slot].bufferSlice = DxvkBufferSlice();
       
+      m_state.gp.descriptors.dirtySlots.set(slot);
+      m_state.cp.descriptors.dirtySlots.set(slot);
+      
       m_flags.set(
         DxvkContextFlag::CpDirtyResources,
         DxvkContextFlag::GpDirtyResources);
@@ -872,12 +886,69 @@ namespace dxvk {
     if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
       m_flags.set(DxvkContextFlag::GpDirtyVertexBuffers);
     
-    if (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT
-               | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+    // Uniform buffers only need their dynamic offsets to be
+    // updated, unless the new slice belongs to a different
+    // physical buffer, which is checked at draw time.
+    if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
                | VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT
-               | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT))
+               | VK_BUFFER_USAGE_STORAGE_TEXEL_BUFFER_BIT)) {
+      // We don't know which slots the buffer is bound
+      // to, so all bindings need to be resolved again
+      m_state.gp.descriptors.dirtySlots.setAll();
+      m_state.cp.descriptors.dirtySlots.setAll();
+      
       m_flags.set(DxvkContextFlag::GpDirtyResources,
                   DxvkContextFlag::CpDirtyResources);
+    } else if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+      m_flags.set(DxvkContextFlag::GpDirtyDescriptorOffsets,
+                  DxvkContextFlag::CpDirtyDescriptorOffsets);
+    }
+  }
+  
+  
+  void DxvkContext::relocateBuffer(
+    const Rc<DxvkBuffer>&           buffer) {
+    this->relocateBuffer(buffer, buffer->relocate());
+  }
+  
+  
+  void DxvkContext::relocateBuffer(
+    const Rc<DxvkBuffer>&           buffer,
+    const DxvkPhysicalBufferSlice&  dstSlice) {
+    this->renderPassEnd();
+    
+    auto srcSlice = buffer->slice();
+    
+    VkBufferCopy bufferRegion;
+    bufferRegion.srcOffset = srcSlice.offset();
+    bufferRegion.dstOffset = dstSlice.offset();
+    bufferRegion.size      = srcSlice.length();
+    
+    m_cmd->cmdCopyBuffer(
+      srcSlice.handle(),
+      dstSlice.handle(),
+      1, &bufferRegion);
+    
+    m_barriers.accessBuffer(srcSlice,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_READ_BIT,
+      buffer->info().stages,
+      buffer->info().access);
+    
+    m_barriers.accessBuffer(dstSlice,
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      buffer->info().stages,
+      buffer->info().access);
+    
+    m_barriers.recordCommands(m_cmd);
+    
+    m_cmd->trackResource(srcSlice.resource());
+    m_cmd->trackResource(dstSlice.resource());
+    
+    // The old backing buffer is kept alive by the command
+    // list and gets released once the copy has completed
+    this->invalidateBuffer(buffer, dstSlice);
   }
   
   
@@ -1336,6 +1407,7 @@ namespace dxvk {
       m_flags.clr(DxvkContextFlag::CpDirtyPipeline);
       
       m_state.cp.state.bsBindingState.clear();
+      m_state.cp.descriptors.dirtySlots.setAll();
       m_state.cp.pipeline = m_device->createComputePipeline(
         m_state.cp.cs.shader);
       
@@ -1367,6 +1439,7 @@ namespace dxvk {
       m_flags.clr(DxvkContextFlag::GpDirtyPipeline);
       
       m_state.gp.state.bsBindingState.clear();
+      m_state.gp.descriptors.dirtySlots.setAll();
       m_state.gp.pipeline = m_device->createGraphicsPipeline(
         m_state.gp.vs.shader, m_state.gp.tcs.shader, m_state.gp.tes.shader,
         m_state.gp.gs.shader, m_state.gp.fs.shader);
@@ -1417,6 +1490,16 @@ namespace dxvk {
   
   
   void DxvkContext::updateComputeShaderResources() {
+    // Renamed uniform buffers don't mark their slots as dirty,
+    // so this must run even if other resources have changed.
+    if (m_flags.test(DxvkContextFlag::CpDirtyDescriptorOffsets)) {
+      if (m_state.cp.pipeline == nullptr
+       || !this->updateShaderDescriptorOffsets(
+            m_state.cp.descriptors,
+            m_state.cp.pipeline->layout()))
+        m_flags.set(DxvkContextFlag::CpDirtyResources);
+    }
+    
     if (m_flags.test(DxvkContextFlag::CpDirtyResources)) {
       if (m_state.cp.pipeline != nullptr) {
         this->updateShaderResources(
@@ -1429,7 +1512,8 @@ namespace dxvk {
   
   void DxvkContext::updateComputeShaderDescriptors() {
     if (m_flags.test(DxvkContextFlag::CpDirtyResources)) {
-      m_flags.clr(DxvkContextFlag::CpDirtyResources);
+      m_flags.clr(DxvkContextFlag::CpDirtyResources,
+                  DxvkContextFlag::CpDirtyDescriptorOffsets);
       
       if (m_state.cp.pipeline != nullptr) {
         this->updateShaderDescriptors(
@@ -1437,11 +1521,27 @@ namespace dxvk {
           m_state.cp.state.bsBindingState,
           m_state.cp.pipeline->layout());
       }
+    } else if (m_flags.test(DxvkContextFlag::CpDirtyDescriptorOffsets)) {
+      m_flags.clr(DxvkContextFlag::CpDirtyDescriptorOffsets);
+      
+      this->bindShaderDescriptors(
+        VK_PIPELINE_BIND_POINT_COMPUTE,
+        m_state.cp.pipeline->layout());
     }
   }
   
   
   void DxvkContext::updateGraphicsShaderResources() {
+    // Renamed uniform buffers don't mark their slots as dirty,
+    // so this must run even if other resources have changed.
+    if (m_flags.test(DxvkContextFlag::GpDirtyDescriptorOffsets)) {
+      if (m_state.gp.pipeline == nullptr
+       || !this->updateShaderDescriptorOffsets(
+            m_state.gp.descriptors,
+            m_state.gp.pipeline->layout()))
+        m_flags.set(DxvkContextFlag::GpDirtyResources);
+    }
+    
     if (m_flags.test(DxvkContextFlag::GpDirtyResources)) {
       if (m_state.gp.pipeline != nullptr) {
         this->updateShaderResources(
@@ -1454,7 +1554,8 @@ namespace dxvk {
   
   void DxvkContext::updateGraphicsShaderDescriptors() {
     if (m_flags.test(DxvkContextFlag::GpDirtyResources)) {
-      m_flags.clr(DxvkContextFlag::GpDirtyResources);
+      m_flags.clr(DxvkContextFlag::GpDirtyResources,
+                  DxvkContextFlag::GpDirtyDescriptorOffsets);
       
       if (m_state.gp.pipeline != nullptr) {
         this->updateShaderDescriptors(
@@ -1462,6 +1563,12 @@ namespace dxvk {
           m_state.gp.state.bsBindingState,
           m_state.gp.pipeline->layout());
       }
+    } else if (m_flags.test(DxvkContextFlag::GpDirtyDescriptorOffsets)) {
+      m_flags.clr(DxvkContextFlag::GpDirtyDescriptorOffsets);
+      
+      this->bindShaderDescriptors(
+        VK_PIPELINE_BIND_POINT_GRAPHICS,
+        m_state.gp.pipeline->layout());
     }
   }
   
@@ -1474,30 +1581,49 @@ namespace dxvk {
         ? m_state.gp.state.bsBindingState
         : m_state.cp.state.bsBindingState;
     
+    DxvkDescriptorSetState& descriptors =
+      bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+        ? m_state.gp.descriptors
+        : m_state.cp.descriptors;
+    
     bool updatePipelineState = false;
     
+    uint32_t dynamicOffsetId = 0;
+    
     DxvkAttachment depthAttachment;
     
     if (bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS && m_state.om.framebuffer != nullptr)
       DxvkAttachment depthAttachment = m_state.om.framebuffer->renderTargets().getDepthTarget();
     
+    // Only resolve bindings whose resource slot has changed
+    // since the last update. Everything else is still valid
+    // and already tracked by the current command list, since
+    // all slots are marked as dirty whenever the pipeline
+    // layout or the command list changes.
     for (uint32_t i = 0; i < layout->bindingCount(); i++) {
       const auto& binding = layout->binding(i);
-      const auto& res     = m_rc[binding.slot];
+      
+      if (!descriptors.dirtySlots.test(binding.slot)) {
+        if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+          dynamicOffsetId += 1;
+        continue;
+      }
+      
+      const auto& res = m_rc[binding.slot];
       
       switch (binding.type) {
         case VK_DESCRIPTOR_TYPE_SAMPLER:
           if (res.sampler != nullptr) {
             updatePipelineState |= bindingState.setBound(i);
             
-            m_descInfos[i].image.sampler     = res.sampler->handle();
-            m_descInfos[i].image.imageView   = VK_NULL_HANDLE;
-            m_descInfos[i].image.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            descriptors.infos[i].image.sampler     = res.sampler->handle();
+            descriptors.infos[i].image.imageView   = VK_NULL_HANDLE;
+            descriptors.infos[i].image.imageLayout = VK_IMAGE_LAYOUT_UNDEFINED;
             
             m_cmd->trackResource(res.sampler);
           } else {
             updatePipelineState |= bindingState.setUnbound(i);
-            m_descInfos[i].image = m_device->dummySamplerDescriptor();
+            descriptors.infos[i].image = m_device->dummySamplerDescriptor();
           } break;
         
         case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
@@ -1505,19 +1631,19 @@ namespace dxvk {
           if (res.imageView != nullptr && res.imageView->type() == binding.view) {
             updatePipelineState |= bindingState.setBound(i);
             
-            m_descInfos[i].image.sampler     = VK_NULL_HANDLE;
-            m_descInfos[i].image.imageView   = res.imageView->handle();
-            m_descInfos[i].image.imageLayout = res.imageView->imageInfo().layout;
+            descriptors.infos[i].image.sampler     = VK_NULL_HANDLE;
+            descriptors.infos[i].image.imageView   = res.imageView->handle();
+            descriptors.infos[i].image.imageLayout = res.imageView->imageInfo().layout;
             
             if (depthAttachment.view != nullptr
              && depthAttachment.view->image() == res.imageView->image())
-              m_descInfos[i].image.imageLayout = depthAttachment.layout;
+              descriptors.infos[i].image.imageLayout = depthAttachment.layout;
             
             m_cmd->trackResource(res.imageView);
             m_cmd->trackResource(res.imageView->image());
           } else {
             updatePipelineState |= bindingState.setUnbound(i);
-            m_descInfos[i].image = m_device->dummyImageViewDescriptor(binding.view);
+            descriptors.infos[i].image = m_device->dummyImageViewDescriptor(binding.view);
           } break;
         
         case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
@@ -1526,13 +1652,13 @@ namespace dxvk {
             updatePipelineState |= bindingState.setBound(i);
             
             res.bufferView->updateView();
-            m_descInfos[i].texelBuffer = res.bufferView->handle();
+            descriptors.infos[i].texelBuffer = res.bufferView->handle();
             
             m_cmd->trackResource(res.bufferView->viewResource());
             m_cmd->trackResource(res.bufferView->bufferResource());
           } else {
             updatePipelineState |= bindingState.setUnbound(i);
-            m_descInfos[i].texelBuffer = m_device->dummyBufferViewDescriptor();
+            descriptors.infos[i].texelBuffer = m_device->dummyBufferViewDescriptor();
           } break;
         
         case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
@@ -1541,14 +1667,36 @@ namespace dxvk {
             updatePipelineState |= bindingState.setBound(i);
             
             auto physicalSlice = res.bufferSlice.physicalSlice();
-            m_descInfos[i].buffer.buffer = physicalSlice.handle();
-            m_descInfos[i].buffer.offset = physicalSlice.offset();
-            m_descInfos[i].buffer.range  = physicalSlice.length();
+            descriptors.infos[i].buffer.buffer = physicalSlice.handle();
+            descriptors.infos[i].buffer.offset = physicalSlice.offset();
+            descriptors.infos[i].buffer.range  = physicalSlice.length();
+            
+            m_cmd->trackResource(physicalSlice.resource());
+          } else {
+            updatePipelineState |= bindingState.setUnbound(i);
+            descriptors.infos[i].buffer = m_device->dummyBufferDescriptor();
+          } break;
+        
+        case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC:
+          // The offset of the physical slice is passed as a dynamic
+          // offset, so that renaming the buffer within the same
+          // physical buffer does not require a new descriptor set.
+          if (res.bufferSlice.defined()) {
+            updatePipelineState |= bindingState.setBound(i);
+            
+            auto physicalSlice = res.bufferSlice.physicalSlice();
+            descriptors.infos[i].buffer.buffer = physicalSlice.handle();
+            descriptors.infos[i].buffer.offset = 0;
+            descriptors.infos[i].buffer.range  = physicalSlice.length();
+            
+            descriptors.dynamicOffsets[dynamicOffsetId++] = physicalSlice.offset();
             
             m_cmd->trackResource(physicalSlice.resource());
           } else {
             updatePipelineState |= bindingState.setUnbound(i);
-            m_descInfos[i].buffer = m_device->dummyBufferDescriptor();
+            descriptors.infos[i].buffer = m_device->dummyBufferDescriptor();
+            
+            descriptors.dynamicOffsets[dynamicOffsetId++] = 0;
           } break;
         
         default:
@@ -1556,6 +1704,8 @@ namespace dxvk {
       }
     }
     
+    descriptors.dirtySlots.clear();
+    
     if (updatePipelineState) {
       m_flags.set(bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
         ? DxvkContextFlag::GpDirtyPipelineState
@@ -1568,19 +1718,111 @@ namespace dxvk {
           VkPipelineBindPoint     bindPoint,
     const DxvkBindingState&       bindingState,
     const Rc<DxvkPipelineLayout>& layout) {
-    const VkDescriptorSet dset =
-      m_cmd->allocateDescriptorSet(
+    DxvkDescriptorSetState& descriptors =
+      bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+        ? m_state.gp.descriptors
+        : m_state.cp.descriptors;
+    
+    // Applications often bind the same set of resources
+    // many times per frame, so try to reuse a descriptor
+    // set that has already been written with the exact
+    // same descriptors in the current command list.
+    const size_t hash = DxvkDescriptorSetCache::computeHash(
+      layout.ptr(), descriptors.infos.data());
+    
+    descriptors.set = m_cmd->lookupDescriptorSet(
+      layout.ptr(), descriptors.infos.data(), hash);
+    
+    if (descriptors.set == VK_NULL_HANDLE) {
+      descriptors.set = m_cmd->allocateDescriptorSet(
         layout->descriptorSetLayout());
+      
+      if (layout->descriptorTemplate() != VK_NULL_HANDLE) {
+        m_cmd->updateDescriptorSetWithTemplate(descriptors.set,
+          layout->descriptorTemplate(), descriptors.infos.data());
+      } else {
+        for (uint32_t i = 0; i < layout->bindingCount(); i++) {
+          m_descWrites[i].dstSet           = descriptors.set;
+          m_descWrites[i].descriptorType   = layout->binding(i).type;
+          m_descWrites[i].pImageInfo       = &descriptors.infos[i].image;
+          m_descWrites[i].pBufferInfo      = &descriptors.infos[i].buffer;
+          m_descWrites[i].pTexelBufferView = &descriptors.infos[i].texelBuffer;
+        }
+        
+        m_cmd->updateDescriptorSet(
+          layout->bindingCount(), m_descWrites.data());
+      }
+      
+      m_cmd->cacheDescriptorSet(layout.ptr(),
+        descriptors.infos.data(), hash, descriptors.set);
+    }
+    
+    this->bindShaderDescriptors(bindPoint, layout);
+  }
+  
+  
+  bool DxvkContext::updateShaderDescriptorOffsets(
+          DxvkDescriptorSetState& descriptors,
+    const Rc<DxvkPipelineLayout>& layout) {
+    uint32_t dynamicOffsetId = 0;
     
+    bool result = true;
+    
+    // Uniform buffers are the only resources that may have changed,
+    // and as long as they still point to the same physical buffers,
+    // the current descriptor set can be rebound with new offsets.
+    // Any resources used by the set are already being tracked.
+    // Uniform buffers which moved to a different physical buffer
+    // are marked as dirty so that only they need to be resolved.
     for (uint32_t i = 0; i < layout->bindingCount(); i++) {
-      m_descWrites[i].dstSet         = dset;
-      m_descWrites[i].descriptorType = layout->binding(i).type;
+      const auto& binding = layout->binding(i);
+      const auto& res     = m_rc[binding.slot];
+      const auto& info    = descriptors.infos[i].buffer;
+      
+      if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC) {
+        const uint32_t offsetId = dynamicOffsetId++;
+        
+        if (res.bufferSlice.defined()) {
+          auto physicalSlice = res.bufferSlice.physicalSlice();
+          
+          if (info.buffer != physicalSlice.handle()
+           || info.range  != physicalSlice.length()) {
+            descriptors.dirtySlots.set(binding.slot);
+            result = false;
+          }
+          
+          descriptors.dynamicOffsets[offsetId] = physicalSlice.offset();
+        }
+      } else if (binding.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+        if (res.bufferSlice.defined()) {
+          auto physicalSlice = res.bufferSlice.physicalSlice();
+          
+          if (info.buffer != physicalSlice.handle()
+           || info.offset != physicalSlice.offset()
+           || info.range  != physicalSlice.length()) {
+            descriptors.dirtySlots.set(binding.slot);
+            result = false;
+          }
+        }
+      }
     }
     
-    m_cmd->updateDescriptorSet(
-      layout->bindingCount(), m_descWrites.data());
+    return result;
+  }
+  
+  
+  void DxvkContext::bindShaderDescriptors(
+          VkPipelineBindPoint     bindPoint,
+    const Rc<DxvkPipelineLayout>& layout) {
+    const DxvkDescriptorSetState& descriptors =
+      bindPoint == VK_PIPELINE_BIND_POINT_GRAPHICS
+        ? m_state.gp.descriptors
+        : m_state.cp.descriptors;
+    
     m_cmd->cmdBindDescriptorSet(bindPoint,
-      layout->pipelineLayout(), dset);
+      layout->pipelineLayout(), descriptors.set,
+      layout->dynamicBindingCount(),
+      descriptors.dynamicOffsets.data());
   }
   
   
@@ -392,6 +392,31 @@ namespace dxvk {
       const Rc<DxvkBuffer>&           buffer,
       const DxvkPhysicalBufferSlice&  slice);
     
+    /**
+     * \brief Moves a buffer to a new memory location
+     * 
+     * Allocates new backing storage for the buffer, copies
+     * the current contents to it and then renames the
+     * buffer. Used to defragment device memory. Only
+     * valid for buffers that are never mapped.
+     * \param [in] buffer The buffer to relocate
+     */
+    void relocateBuffer(
+      const Rc<DxvkBuffer>&           buffer);
+    
+    /**
+     * \brief Moves a buffer to the given backing storage
+     * 
+     * Copies the current contents of the buffer to the
+     * given slice and then renames the buffer. Used to
+     * move buffers out of the uniform buffer ring.
+     * \param [in] buffer The buffer to move
+     * \param [in] slice New physical buffer slice
+     */
+    void relocateBuffer(
+      const Rc<DxvkBuffer>&           buffer,
+      const DxvkPhysicalBufferSlice&  slice);
+    
     /**
      * \brief Resolves a multisampled image resource
      * 
@@ -573,7 +598,6 @@ namespace dxvk {
     std::vector<DxvkQueryRevision> m_activeQueries;
     
     std::array<DxvkShaderResourceSlot, MaxNumResourceSlots>  m_rc;
-    std::array<DxvkDescriptorInfo,     MaxNumActiveBindings> m_descInfos;
     std::array<VkWriteDescriptorSet,   MaxNumActiveBindings> m_descWrites;
     
     void renderPassBegin();
@@ -600,6 +624,14 @@ namespace dxvk {
       const DxvkBindingState&       bindingState,
       const Rc<DxvkPipelineLayout>& layout);
     
+    bool updateShaderDescriptorOffsets(
+            DxvkDescriptorSetState& descriptors,
+      const Rc<DxvkPipelineLayout>& layout);
+    
+    void bindShaderDescriptors(
+            VkPipelineBindPoint     bindPoint,
+      const Rc<DxvkPipelineLayout>& layout);
+    
     void updateViewports();
     void updateBlendConstants();
     void updateStencilReference();
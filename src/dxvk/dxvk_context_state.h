@@ -1,5 +1,6 @@
 #pragma once
 
+#include "dxvk_binding.h"
 #include "dxvk_buffer.h"
 #include "dxvk_compute.h"
 #include "dxvk_constant_state.h"
@@ -25,6 +26,7 @@ namespace dxvk {
     GpDirtyPipeline,            ///< Graphics pipeline binding is out of date
     GpDirtyPipelineState,       ///< Graphics pipeline needs to be recompiled
     GpDirtyResources,           ///< Graphics pipeline resource bindings are out of date
+    GpDirtyDescriptorOffsets,   ///< Graphics pipeline uniform buffer offsets are out of date
     GpDirtyVertexBuffers,       ///< Vertex buffer bindings are out of date
     GpDirtyIndexBuffer,         ///< Index buffer binding are out of date
     GpEmulateInstanceFetchRate, ///< The current input layout uses fetch rates != 1
@@ -32,6 +34,7 @@ namespace dxvk {
     CpDirtyPipeline,            ///< Compute pipeline binding are out of date
     CpDirtyPipelineState,       ///< Compute pipeline needs to be recompiled
     CpDirtyResources,           ///< Compute pipeline resource bindings are out of date
+    CpDirtyDescriptorOffsets,   ///< Compute pipeline uniform buffer offsets are out of date
   };
   
   using DxvkContextFlags = Flags<DxvkContextFlag>;
@@ -65,6 +68,27 @@ namespace dxvk {
   };
   
   
+  /**
+   * \brief Descriptor set state
+   * 
+   * Stores the descriptor set that is currently bound
+   * to a pipeline, along with the descriptors written
+   * to it. Only bindings whose resource slots are marked
+   * as dirty need to be resolved again when resources
+   * change, and renamed uniform buffers can be rebound
+   * by only changing the dynamic offsets.
+   */
+  struct DxvkDescriptorSetState {
+    VkDescriptorSet      set = VK_NULL_HANDLE;
+    DxvkResourceSlotMask dirtySlots;
+    
+    std::array<DxvkDescriptorInfo,
+      DxvkLimits::MaxNumActiveBindings> infos = { };
+    std::array<uint32_t,
+      DxvkLimits::MaxNumActiveBindings> dynamicOffsets = { };
+  };
+  
+  
   struct DxvkShaderStage {
     Rc<DxvkShader> shader;
   };
@@ -79,6 +103,7 @@ namespace dxvk {
 
     DxvkGraphicsPipelineStateInfo state;
     Rc<DxvkGraphicsPipeline>      pipeline;
+    DxvkDescriptorSetState        descriptors;
   };
   
   
@@ -87,6 +112,7 @@ namespace dxvk {
     
     DxvkComputePipelineStateInfo  state;
     Rc<DxvkComputePipeline>       pipeline;
+    DxvkDescriptorSetState        descriptors;
   };
   
   
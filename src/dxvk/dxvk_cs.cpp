@@ -1,4 +1,5 @@
 #include "dxvk_cs.h"
+#include "dxvk_device.h"
 
 namespace dxvk {
   
@@ -8,22 +9,40 @@ namespace dxvk {
   
   
   DxvkCsChunk::~DxvkCsChunk() {
+    this->reset();
+  }
+  
+  
+  void DxvkCsChunk::executeAll(DxvkContext* ctx) {
     auto cmd = m_head;
     
-    while (cmd != nullptr) {
-      auto next = cmd->next();
-      cmd->~DxvkCsCmd();
-      cmd = next;
+    if (m_flags.test(DxvkCsChunkFlag::SingleUse)) {
+      while (cmd != nullptr) {
+        auto next = cmd->next();
+        cmd->exec(ctx);
+        cmd->~DxvkCsCmd();
+        cmd = next;
+      }
+      
+      m_commandCount  = 0;
+      m_commandOffset = 0;
+      
+      m_head = nullptr;
+      m_tail = nullptr;
+    } else {
+      while (cmd != nullptr) {
+        cmd->exec(ctx);
+        cmd = cmd->next();
+      }
     }
   }
   
   
-  void DxvkCsChunk::executeAll(DxvkContext* ctx) {
+  void DxvkCsChunk::reset() {
     auto cmd = m_head;
     
     while (cmd != nullptr) {
       auto next = cmd->next();
-      cmd->exec(ctx);
       cmd->~DxvkCsCmd();
       cmd = next;
     }
@@ -36,8 +55,11 @@ namespace dxvk {
   }
   
   
-  DxvkCsThread::DxvkCsThread(const Rc<DxvkContext>& context)
-  : m_context(context), m_thread([this] { threadFunc(); }) {
+  DxvkCsThread::DxvkCsThread(
+    const Rc<DxvkDevice>&   device,
+    const Rc<DxvkContext>&  context)
+  : m_device(device), m_context(context),
+    m_thread([this] { threadFunc(); }) {
     
   }
   
@@ -48,64 +70,118 @@ namespace dxvk {
     }
     
     m_condOnAdd.notify_one();
+    m_condOnSync.notify_one();
     m_thread.join();
   }
   
   
   void DxvkCsThread::dispatchChunk(Rc<DxvkCsChunk>&& chunk) {
-    { std::unique_lock<std::mutex> lock(m_mutex);
-      m_chunksQueued.push(std::move(chunk));
-      m_chunksPending += 1;
+    const uint64_t chunkId = m_chunksQueued.load(std::memory_order_relaxed);
+    
+    // Wait until the slot we are about to write has been
+    // consumed. This is the same back-pressure the queue
+    // used to apply via the pending chunk counter.
+    if (chunkId - m_chunksExecuted.load(std::memory_order_acquire) >= MaxChunksInFlight) {
+      waitForConsumer([this, chunkId] {
+        return chunkId - m_chunksExecuted.load() < MaxChunksInFlight;
+      });
       
-      if (m_chunksPending > MaxChunksInFlight) {
-        m_condOnSync.wait(lock, [this] {
-          return (m_chunksPending <= MaxChunksInFlight )
-              || (m_stopped.load());
-        });
-      }
+      if (m_stopped.load())
+        return;
     }
     
-    // Wake CS thread
-    m_condOnAdd.notify_one();
+    m_chunks[chunkId % MaxChunksInFlight] = std::move(chunk);
+    m_chunksQueued.store(chunkId + 1, std::memory_order_seq_cst);
+    
+    // Wake CS thread only if it has gone to sleep
+    if (m_consumerWaiting.load(std::memory_order_seq_cst)) {
+      { std::unique_lock<std::mutex> lock(m_mutex); }
+      m_condOnAdd.notify_one();
+    }
   }
   
   
   void DxvkCsThread::synchronize() {
+    const uint64_t chunkId = m_chunksQueued.load(std::memory_order_relaxed);
+    
+    if (m_chunksExecuted.load(std::memory_order_acquire) != chunkId) {
+      waitForConsumer([this, chunkId] {
+        return m_chunksExecuted.load() == chunkId;
+      });
+    }
+  }
+  
+  
+  // The waiting flag is published before the predicate is checked
+  // under the lock, and the other side publishes its progress before
+  // checking the flag, so at least one of them observes the other.
+  template<typename Pred>
+  void DxvkCsThread::waitForProducer(const Pred& pred) {
+    for (uint32_t i = 0; i < SpinCount; i++) {
+      if (pred() || m_stopped.load())
+        return;
+      std::this_thread::yield();
+    }
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_consumerWaiting.store(true, std::memory_order_seq_cst);
+    
+    m_condOnAdd.wait(lock, [this, &pred] {
+      return pred() || m_stopped.load();
+    });
+    
+    m_consumerWaiting.store(false, std::memory_order_relaxed);
+  }
+  
+  
+  template<typename Pred>
+  void DxvkCsThread::waitForConsumer(const Pred& pred) {
+    for (uint32_t i = 0; i < SpinCount; i++) {
+      if (pred() || m_stopped.load())
+        return;
+      std::this_thread::yield();
+    }
+    
     std::unique_lock<std::mutex> lock(m_mutex);
+    m_producerWaiting.store(true, std::memory_order_seq_cst);
     
-    m_condOnSync.wait(lock, [this] {
-      return m_chunksPending == 0;
+    m_condOnSync.wait(lock, [this, &pred] {
+      return pred() || m_stopped.load();
     });
+    
+    m_producerWaiting.store(false, std::memory_order_relaxed);
   }
   
   
   void DxvkCsThread::threadFunc() {
-    Rc<DxvkCsChunk> chunk;
+    uint64_t chunkId = 0;
     
     while (!m_stopped.load()) {
-      { std::unique_lock<std::mutex> lock(m_mutex);
-        if (chunk != nullptr) {
-          m_chunksPending -= 1;
-          m_condOnSync.notify_one();
-        }
-        
-        if (m_chunksQueued.size() == 0) {
-          m_condOnAdd.wait(lock, [this] {
-            return (m_chunksQueued.size() != 0)
-                || (m_stopped.load());
-          });
-        }
+      if (m_chunksQueued.load(std::memory_order_acquire) == chunkId) {
+        waitForProducer([this, chunkId] {
+          return m_chunksQueued.load() != chunkId;
+        });
         
-        if (m_chunksQueued.size() != 0) {
-          chunk = std::move(m_chunksQueued.front());
-          m_chunksQueued.pop();
-        } else {
-          chunk = nullptr;
-        }
+        if (m_stopped.load())
+          break;
       }
       
-      if (chunk != nullptr)
-        chunk->executeAll(m_context.ptr());
+      Rc<DxvkCsChunk> chunk = std::move(m_chunks[chunkId % MaxChunksInFlight]);
+      chunk->executeAll(m_context.ptr());
+      
+      if (chunk->flags().test(DxvkCsChunkFlag::SingleUse))
+        m_device->recycleCsChunk(chunk);
+      
+      chunk = nullptr;
+      
+      m_chunksExecuted.store(++chunkId, std::memory_order_seq_cst);
+      
+      // Wake the producer if it is blocked on a full
+      // ring or waiting for the thread to go idle
+      if (m_producerWaiting.load(std::memory_order_seq_cst)) {
+        { std::unique_lock<std::mutex> lock(m_mutex); }
+        m_condOnSync.notify_one();
+      }
     }
   }
   
@@ -1,15 +1,17 @@
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
-#include <queue>
 #include <thread>
 
 #include "dxvk_context.h"
 
 namespace dxvk {
   
+  class DxvkDevice;
+  
   /**
    * \brief Command stream operation
    * 
@@ -82,6 +84,20 @@ namespace dxvk {
   };
   
   
+  /**
+   * \brief Command chunk flags
+   */
+  enum class DxvkCsChunkFlag : uint32_t {
+    /// Chunk is only referenced by the thread that
+    /// executes it, which may therefore destroy the
+    /// commands while executing them and return the
+    /// chunk to the device's chunk pool afterwards.
+    SingleUse,
+  };
+  
+  using DxvkCsChunkFlags = Flags<DxvkCsChunkFlag>;
+  
+  
   /**
    * \brief Command chunk
    * 
@@ -94,6 +110,25 @@ namespace dxvk {
     DxvkCsChunk();
     ~DxvkCsChunk();
     
+    /**
+     * \brief Chunk flags
+     * \returns Chunk flags
+     */
+    DxvkCsChunkFlags flags() const {
+      return m_flags;
+    }
+    
+    /**
+     * \brief Sets chunk flags
+     * 
+     * Must only be called while the
+     * chunk does not hold any commands.
+     * \param [in] flags New chunk flags
+     */
+    void setFlags(DxvkCsChunkFlags flags) {
+      m_flags = flags;
+    }
+    
     /**
      * \brief Number of commands recorded to the chunk
      * 
@@ -139,14 +174,28 @@ namespace dxvk {
     /**
      * \brief Executes all commands
      * 
-     * This will also reset the chunk
-     * so that it can be reused.
+     * If the chunk is flagged as single-use, this will
+     * also reset the chunk so that it can be reused.
+     * Otherwise, the commands are preserved so that the
+     * chunk can be executed again, e.g. when a deferred
+     * command list is submitted multiple times. They are
+     * destroyed when the chunk itself is destroyed.
      * \param [in] ctx The context
      */
     void executeAll(DxvkContext* ctx);
     
+    /**
+     * \brief Resets chunk
+     * 
+     * Destroys all recorded commands and
+     * marks the chunk itself as empty.
+     */
+    void reset();
+    
   private:
     
+    DxvkCsChunkFlags m_flags;
+    
     size_t m_commandCount  = 0;
     size_t m_commandOffset = 0;
     
@@ -164,14 +213,27 @@ namespace dxvk {
    * 
    * Spawns a thread that will execute
    * commands on a DXVK context. 
+   * 
+   * Chunks are handed over through a bounded single-producer,
+   * single-consumer ring buffer, so \ref dispatchChunk and
+   * \ref synchronize must only be called from one thread at
+   * a time. Both sides spin for a short while before parking
+   * on a condition variable, which means that the mutex is
+   * only taken when one of the threads actually goes to sleep.
    */
   class DxvkCsThread {
     // Limit the number of chunks in the queue
     // to prevent memory leaks, stuttering etc.
     constexpr static uint32_t MaxChunksInFlight = 32;
+    
+    // Number of times a thread polls the ring before
+    // it goes to sleep on the corresponding condition
+    constexpr static uint32_t SpinCount = 200;
   public:
     
-    DxvkCsThread(const Rc<DxvkContext>& context);
+    DxvkCsThread(
+      const Rc<DxvkDevice>&   device,
+      const Rc<DxvkContext>&  context);
     ~DxvkCsThread();
     
     /**
@@ -179,6 +241,8 @@ namespace dxvk {
      * 
      * Can be used to efficiently play back large
      * command lists recorded on another thread.
+     * Chunks flagged as single-use are returned
+     * to the device's chunk pool once executed.
      * \param [in] chunk The chunk to dispatch
      */
     void dispatchChunk(Rc<DxvkCsChunk>&& chunk);
@@ -195,16 +259,32 @@ namespace dxvk {
     
   private:
     
+    const Rc<DxvkDevice>        m_device;
     const Rc<DxvkContext>       m_context;
     
     std::atomic<bool>           m_stopped = { false };
     std::mutex                  m_mutex;
     std::condition_variable     m_condOnAdd;
     std::condition_variable     m_condOnSync;
-    std::queue<Rc<DxvkCsChunk>> m_chunksQueued;
+    
+    std::array<Rc<DxvkCsChunk>, MaxChunksInFlight> m_chunks;
+    
+    // Written by the producer and the consumer,
+    // respectively. Kept on separate cache lines
+    // so that the two threads do not contend.
+    alignas(64) std::atomic<uint64_t> m_chunksQueued   = { 0ull };
+    alignas(64) std::atomic<uint64_t> m_chunksExecuted = { 0ull };
+    
+    alignas(64) std::atomic<bool> m_producerWaiting = { false };
+    alignas(64) std::atomic<bool> m_consumerWaiting = { false };
+    
     std::thread                 m_thread;
     
-    uint32_t                    m_chunksPending = 0;
+    template<typename Pred>
+    void waitForProducer(const Pred& pred);
+    
+    template<typename Pred>
+    void waitForConsumer(const Pred& pred);
     
     void threadFunc();
     
@@ -0,0 +1,115 @@
+#include "dxvk_defrag.h"
+#include "dxvk_device.h"
+
+namespace dxvk {
+  
+  DxvkDefragmenter::DxvkDefragmenter(DxvkDevice* device)
+  : m_device(device) {
+    
+  }
+  
+  
+  DxvkDefragmenter::~DxvkDefragmenter() {
+    
+  }
+  
+  
+  void DxvkDefragmenter::registerBuffer(DxvkBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.insert({ buffer, m_serial++ });
+  }
+  
+  
+  void DxvkDefragmenter::unregisterBuffer(DxvkBuffer* buffer) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_buffers.erase(buffer);
+  }
+  
+  
+  uint64_t DxvkDefragmenter::serial() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_serial;
+  }
+  
+  
+  void DxvkDefragmenter::run(
+          DxvkContext*  ctx,
+          uint64_t      serial) {
+    if (!m_active) {
+      const auto now = DxvkMemoryClock::now();
+      
+      if (now - m_lastPass < PassInterval)
+        return;
+      
+      m_lastPass = now;
+      m_active   = m_device->m_memory->beginDefrag() != 0;
+      
+      if (!m_active)
+        return;
+    }
+    
+    std::vector<Rc<DxvkBuffer>> buffers = this->pickBuffers(serial);
+    
+    // Once no more buffers need to be moved, any chunks that
+    // could not be emptied can be used for allocations again.
+    // Evacuated chunks will be freed once the GPU is done
+    // with the copies and the old buffers get destroyed.
+    if (buffers.size() == 0) {
+      m_device->m_memory->endDefrag();
+      m_active   = false;
+      m_lastPass = DxvkMemoryClock::now();
+      return;
+    }
+    
+    for (const auto& buffer : buffers) {
+      ctx->relocateBuffer(buffer);
+      
+      m_movedBuffers += 1;
+      m_movedBytes   += buffer->info().size;
+    }
+  }
+  
+  
+  DxvkStatCounters DxvkDefragmenter::getStatCounters() const {
+    DxvkStatCounters result;
+    result.setCtr(DxvkStatCounter::MemoryMovedBuffers, m_movedBuffers.load());
+    result.setCtr(DxvkStatCounter::MemoryMovedBytes,   m_movedBytes.load());
+    return result;
+  }
+  
+  
+  std::vector<Rc<DxvkBuffer>> DxvkDefragmenter::pickBuffers(
+          uint64_t      serial) {
+    std::vector<Rc<DxvkBuffer>> result;
+    VkDeviceSize                size = 0;
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (const auto& entry : m_buffers) {
+      if (size >= MaxBytesPerStep)
+        break;
+      
+      if (entry.second >= serial)
+        continue;
+      
+      // Registered buffers stay valid while we hold the
+      // lock, but the buffer may already be in the process
+      // of being destroyed, in which case its destructor
+      // is waiting for the lock to unregister the buffer.
+      DxvkBuffer* buffer = entry.first;
+      
+      if (!buffer->needsRelocation() || !buffer->tryIncRef())
+        continue;
+      
+      result.push_back(buffer);
+      size += buffer->info().size;
+      
+      // Cannot drop to zero since the new
+      // Rc also holds a reference now
+      buffer->decRef();
+    }
+    
+    return result;
+  }
+  
+}
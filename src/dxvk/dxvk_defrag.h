@@ -0,0 +1,106 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "dxvk_buffer.h"
+#include "dxvk_memory.h"
+#include "dxvk_stats.h"
+
+namespace dxvk {
+  
+  class DxvkContext;
+  class DxvkDevice;
+  
+  /**
+   * \brief Memory defragmenter
+   *
+   * Keeps track of buffers that are never mapped by
+   * the host. When run, sparsely used device memory
+   * chunks are marked for evacuation and the buffers
+   * located in them are moved to other chunks with GPU
+   * copies, so that the emptied chunks can be freed.
+   *
+   * Only a limited amount of memory is moved per step
+   * in order to avoid stutter, and a new pass is only
+   * started a few seconds after the previous one ended.
+   */
+  class DxvkDefragmenter {
+    
+  public:
+    
+    DxvkDefragmenter(DxvkDevice* device);
+    ~DxvkDefragmenter();
+    
+    /**
+     * \brief Registers a relocatable buffer
+     *
+     * The buffer must unregister itself before
+     * it gets destroyed. Buffers are identified
+     * by a serial number, see \ref serial.
+     * \param [in] buffer The buffer
+     */
+    void registerBuffer(DxvkBuffer* buffer);
+    
+    /**
+     * \brief Unregisters a buffer
+     * \param [in] buffer The buffer
+     */
+    void unregisterBuffer(DxvkBuffer* buffer);
+    
+    /**
+     * \brief Current buffer serial number
+     *
+     * Buffers registered after this has been queried are
+     * ignored by the corresponding defragmentation step,
+     * since their initial data may not have been uploaded
+     * yet at the time the step gets executed.
+     * \returns Serial number of the next buffer
+     */
+    uint64_t serial();
+    
+    /**
+     * \brief Runs a defragmentation step
+     *
+     * Records commands to move buffers that are located
+     * in sparsely used chunks into the given context.
+     * \param [in] ctx The context to record commands into
+     * \param [in] serial Buffer serial number limit
+     */
+    void run(
+            DxvkContext*  ctx,
+            uint64_t      serial);
+    
+    /**
+     * \brief Retrieves defragmentation statistics
+     * \returns Stat counters
+     */
+    DxvkStatCounters getStatCounters() const;
+    
+  private:
+    
+    /// Maximum amount of buffer memory moved per step
+    static constexpr VkDeviceSize MaxBytesPerStep = 16 << 20;
+    
+    /// Minimum time between two defragmentation passes
+    static constexpr std::chrono::seconds PassInterval = std::chrono::seconds(5);
+    
+    DxvkDevice* m_device;
+    
+    std::mutex                                m_mutex;
+    std::unordered_map<DxvkBuffer*, uint64_t> m_buffers;
+    uint64_t                                  m_serial = 0;
+    
+    bool                        m_active = false;
+    DxvkMemoryClock::time_point m_lastPass;
+    
+    std::atomic<uint64_t> m_movedBuffers = { 0ull };
+    std::atomic<uint64_t> m_movedBytes   = { 0ull };
+    
+    std::vector<Rc<DxvkBuffer>> pickBuffers(
+            uint64_t      serial);
+    
+  };
+  
+}
@@ -1,7 +1,62 @@
 #include "dxvk_descriptor.h"
+#include "dxvk_hash.h"
 
 namespace dxvk {
   
+  static size_t hashDescriptorInfo(
+          VkDescriptorType    type,
+    const DxvkDescriptorInfo& info) {
+    DxvkHashState result;
+    
+    switch (type) {
+      case VK_DESCRIPTOR_TYPE_SAMPLER:
+      case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+      case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        result.add(std::hash<VkSampler>()  (info.image.sampler));
+        result.add(std::hash<VkImageView>()(info.image.imageView));
+        result.add(std::hash<uint32_t>()   (info.image.imageLayout));
+        break;
+      
+      case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        result.add(std::hash<VkBufferView>()(info.texelBuffer));
+        break;
+      
+      default:
+        result.add(std::hash<VkBuffer>()    (info.buffer.buffer));
+        result.add(std::hash<VkDeviceSize>()(info.buffer.offset));
+        result.add(std::hash<VkDeviceSize>()(info.buffer.range));
+    }
+    
+    return result;
+  }
+  
+  
+  static bool compareDescriptorInfo(
+          VkDescriptorType    type,
+    const DxvkDescriptorInfo& a,
+    const DxvkDescriptorInfo& b) {
+    switch (type) {
+      case VK_DESCRIPTOR_TYPE_SAMPLER:
+      case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+      case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        return a.image.sampler     == b.image.sampler
+            && a.image.imageView   == b.image.imageView
+            && a.image.imageLayout == b.image.imageLayout;
+      
+      case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+      case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        return a.texelBuffer == b.texelBuffer;
+      
+      default:
+        return a.buffer.buffer == b.buffer.buffer
+            && a.buffer.offset == b.buffer.offset
+            && a.buffer.range  == b.buffer.range;
+    }
+  }
+  
+  
+  
   DxvkDescriptorAlloc::DxvkDescriptorAlloc(
     const Rc<vk::DeviceFn>& vkd)
   : m_vkd(vkd) {
@@ -48,14 +103,15 @@ namespace dxvk {
     constexpr uint32_t MaxSets = 256;
     constexpr uint32_t MaxDesc = 2048;
     
-    std::array<VkDescriptorPoolSize, 7> pools = {{
-      { VK_DESCRIPTOR_TYPE_SAMPLER,               MaxDesc },
-      { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,         MaxDesc },
-      { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,         MaxDesc },
-      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,        MaxDesc },
-      { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,        MaxDesc },
-      { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,  MaxDesc },
-      { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,  MaxDesc } }};
+    std::array<VkDescriptorPoolSize, 8> pools = {{
+      { VK_DESCRIPTOR_TYPE_SAMPLER,                MaxDesc },
+      { VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,          MaxDesc },
+      { VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          MaxDesc },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         MaxDesc },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, MaxDesc },
+      { VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         MaxDesc },
+      { VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER,   MaxDesc },
+      { VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER,   MaxDesc } }};
     
     VkDescriptorPoolCreateInfo info;
     info.sType         = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -89,4 +145,104 @@ namespace dxvk {
     return set;
   }
   
+  
+  DxvkDescriptorSetCache::DxvkDescriptorSetCache() {
+    m_buckets.fill(InvalidEntry);
+    m_entries.reserve(MaxEntries);
+  }
+  
+  
+  DxvkDescriptorSetCache::~DxvkDescriptorSetCache() {
+    
+  }
+  
+  
+  size_t DxvkDescriptorSetCache::computeHash(
+    const DxvkPipelineLayout*   layout,
+    const DxvkDescriptorInfo*   infos) {
+    DxvkHashState result;
+    result.add(std::hash<VkDescriptorSetLayout>()(layout->descriptorSetLayout()));
+    
+    for (uint32_t i = 0; i < layout->bindingCount(); i++)
+      result.add(hashDescriptorInfo(layout->binding(i).type, infos[i]));
+    
+    return result;
+  }
+  
+  
+  VkDescriptorSet DxvkDescriptorSetCache::lookup(
+    const DxvkPipelineLayout*   layout,
+    const DxvkDescriptorInfo*   infos,
+          size_t                hash) {
+    uint32_t index = m_buckets[hash % BucketCount];
+    
+    while (index != InvalidEntry) {
+      const Entry& entry = m_entries[index];
+      index = entry.next;
+      
+      if (entry.hash   != hash
+       || entry.layout != layout->descriptorSetLayout())
+        continue;
+      
+      bool eq = true;
+      
+      for (uint32_t i = 0; i < layout->bindingCount() && eq; i++) {
+        eq = compareDescriptorInfo(layout->binding(i).type,
+          infos[i], m_infos[entry.infoIndex + i]);
+      }
+      
+      if (eq) {
+        m_hits += 1;
+        return entry.set;
+      }
+    }
+    
+    m_misses += 1;
+    return VK_NULL_HANDLE;
+  }
+  
+  
+  void DxvkDescriptorSetCache::insert(
+    const DxvkPipelineLayout*   layout,
+    const DxvkDescriptorInfo*   infos,
+          size_t                hash,
+          VkDescriptorSet       set) {
+    if (m_entries.size() >= MaxEntries)
+      return;
+    
+    uint32_t& bucket = m_buckets[hash % BucketCount];
+    
+    Entry entry;
+    entry.hash      = hash;
+    entry.layout    = layout->descriptorSetLayout();
+    entry.infoIndex = m_infos.size();
+    entry.set       = set;
+    entry.next      = bucket;
+    
+    bucket = m_entries.size();
+    
+    m_infos.insert(m_infos.end(), infos, infos + layout->bindingCount());
+    m_entries.push_back(entry);
+  }
+  
+  
+  DxvkStatCounters DxvkDescriptorSetCache::getStatCounters() const {
+    DxvkStatCounters result;
+    result.setCtr(DxvkStatCounter::DescSetCacheHits,   m_hits);
+    result.setCtr(DxvkStatCounter::DescSetCacheMisses, m_misses);
+    return result;
+  }
+  
+  
+  void DxvkDescriptorSetCache::reset() {
+    // Clearing the vectors keeps their capacity, so
+    // the next command list does not allocate again
+    m_buckets.fill(InvalidEntry);
+    m_entries.clear();
+    m_infos.clear();
+    
+    m_hits   = 0;
+    m_misses = 0;
+  }
+  
 }
\ No newline at end of file
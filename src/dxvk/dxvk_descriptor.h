@@ -1,6 +1,11 @@
 #pragma once
 
+#include <array>
+#include <vector>
+
 #include "dxvk_include.h"
+#include "dxvk_pipelayout.h"
+#include "dxvk_stats.h"
 
 namespace dxvk {
   
@@ -66,4 +71,107 @@ namespace dxvk {
     
   };
   
-}
\ No newline at end of file
+  
+  /**
+   * \brief Descriptor set cache
+   * 
+   * Maps the contents of a descriptor set to a set that
+   * has already been written with the same descriptors,
+   * so that binding the same resources again does not
+   * require allocating and writing a new set. Cached sets
+   * are only valid until the descriptor pools they were
+   * allocated from get reset, so both must be reset at
+   * the same time.
+   * 
+   * The number of cached sets is bounded, and the storage
+   * is retained across resets, so that inserting sets does
+   * not allocate memory once the command list is warmed up.
+   */
+  class DxvkDescriptorSetCache {
+    constexpr static uint32_t BucketCount  = 1024;
+    constexpr static uint32_t MaxEntries   = 4096;
+    constexpr static uint32_t InvalidEntry = ~0u;
+  public:
+    
+    DxvkDescriptorSetCache();
+    ~DxvkDescriptorSetCache();
+    
+    /**
+     * \brief Computes hash of descriptor set contents
+     * 
+     * Only considers the members of each descriptor
+     * info that are relevant for the descriptor type.
+     * \param [in] layout Pipeline layout
+     * \param [in] infos Descriptor infos, one per binding
+     * \returns Hash of the descriptor set contents
+     */
+    static size_t computeHash(
+      const DxvkPipelineLayout*   layout,
+      const DxvkDescriptorInfo*   infos);
+    
+    /**
+     * \brief Looks up a descriptor set
+     * 
+     * \param [in] layout Pipeline layout
+     * \param [in] infos Descriptor infos, one per binding
+     * \param [in] hash Hash as returned by \ref computeHash
+     * \returns Descriptor set with the given contents, or
+     *          \c VK_NULL_HANDLE if no such set exists
+     */
+    VkDescriptorSet lookup(
+      const DxvkPipelineLayout*   layout,
+      const DxvkDescriptorInfo*   infos,
+            size_t                hash);
+    
+    /**
+     * \brief Adds a descriptor set to the cache
+     * 
+     * Does nothing if the cache is already full.
+     * \param [in] layout Pipeline layout
+     * \param [in] infos Descriptor infos, one per binding
+     * \param [in] hash Hash as returned by \ref computeHash
+     * \param [in] set Descriptor set written with \c infos
+     */
+    void insert(
+      const DxvkPipelineLayout*   layout,
+      const DxvkDescriptorInfo*   infos,
+            size_t                hash,
+            VkDescriptorSet       set);
+    
+    /**
+     * \brief Retrieves lookup statistics
+     * 
+     * Counts cache hits and misses since
+     * the cache was last reset.
+     * \returns Stat counters
+     */
+    DxvkStatCounters getStatCounters() const;
+    
+    /**
+     * \brief Resets the cache
+     * 
+     * Removes all descriptor sets from the
+     * cache and resets the stat counters.
+     */
+    void reset();
+    
+  private:
+    
+    struct Entry {
+      size_t                hash;
+      VkDescriptorSetLayout layout;
+      size_t                infoIndex;
+      VkDescriptorSet       set;
+      uint32_t              next;
+    };
+    
+    std::array<uint32_t, BucketCount> m_buckets;
+    std::vector<Entry>                m_entries;
+    std::vector<DxvkDescriptorInfo>   m_infos;
+    
+    uint64_t m_hits   = 0;
+    uint64_t m_misses = 0;
+    
+  };
+  
+}
@@ -1,3 +1,5 @@
+#include <cstdlib>
+
 #include "dxvk_device.h"
 #include "dxvk_instance.h"
 
@@ -12,29 +14,85 @@ namespace dxvk {
     m_vkd             (vkd),
     m_extensions      (extensions),
     m_features        (features),
-    m_memory          (new DxvkMemoryAllocator(adapter, vkd)),
+    m_properties      (adapter->deviceProperties()),
+    m_memory          (new DxvkMemoryAllocator(adapter, vkd, *extensions)),
     m_renderPassPool  (new DxvkRenderPassPool (vkd)),
     m_pipelineCache   (new DxvkPipelineCache  (vkd)),
     m_pipelineManager (new DxvkPipelineManager(this)),
     m_unboundResources(this),
+    m_defragmenter    (this),
+    m_uniformRing     (this),
+    m_stagingRing     (this),
+    m_stagingData     (this),
+    m_uploader        (this),
     m_submissionQueue (this) {
     m_options.adjustAppOptions(env::getExeName());
     m_options.adjustDeviceOptions(m_adapter);
     m_options.logOptions();
     
+    // Periodically dump memory statistics to the log
+    // if an interval in seconds is given by the user
+    const std::string memoryLogInterval = env::getEnvVar(L"DXVK_MEMORY_LOG_INTERVAL");
+    
+    if (!memoryLogInterval.empty()) {
+      char* end = nullptr;
+      const unsigned long value = std::strtoul(memoryLogInterval.c_str(), &end, 10);
+      
+      if (end != memoryLogInterval.c_str() && *end == '\0')
+        m_memoryLogInterval = std::chrono::seconds(value);
+      else
+        Logger::warn(str::format("DxvkDevice: Invalid memory log interval: ", memoryLogInterval));
+    }
+    
+    m_memoryLogTime = DxvkMemoryClock::now();
+    
     m_vkd->vkGetDeviceQueue(m_vkd->device(),
       m_adapter->graphicsQueueFamily(), 0,
       &m_graphicsQueue);
     m_vkd->vkGetDeviceQueue(m_vkd->device(),
       m_adapter->presentQueueFamily(), 0,
       &m_presentQueue);
+    m_vkd->vkGetDeviceQueue(m_vkd->device(),
+      m_adapter->transferQueueFamily(), 0,
+      &m_transferQueue);
   }
   
   
   DxvkDevice::~DxvkDevice() {
     // Wait for all pending Vulkan commands to be
     // executed before we destroy any resources.
+    m_submissionQueue.synchronize();
     m_vkd->vkDeviceWaitIdle(m_vkd->device());
+    
+    const DxvkStatCounters submitStats  = m_submissionQueue.getStatCounters();
+    const DxvkStatCounters stagingStats = m_stagingRing.getStatCounters();
+    
+    Logger::debug(str::format("DxvkDevice: CS chunk pool: ",
+      m_csChunkPoolHits.load(), " hits, ",
+      m_csChunkPoolMisses.load(), " misses"));
+    
+    Logger::debug(str::format("DxvkDevice: Buffer discards: ",
+      m_bufferRenames.load(), " renames, ",
+      m_bufferReallocs.load(), " reallocations"));
+    
+    Logger::debug(str::format("DxvkDevice: Descriptor set cache: ",
+      m_descSetHits.load(), " hits, ",
+      m_descSetMisses.load(), " misses"));
+    
+    Logger::debug(str::format("DxvkDevice: Staging ring: ",
+      stagingStats.getCtr(DxvkStatCounter::StagingBytes) >> 10, " kB staged, ",
+      stagingStats.getCtr(DxvkStatCounter::StagingRingWraps), " wraparounds, ",
+      stagingStats.getCtr(DxvkStatCounter::StagingAllocCount), " buffers allocated"));
+    
+    // Time spent in vkQueueSubmit minus the time spent
+    // handing command lists over to the submission thread
+    Logger::debug(str::format("DxvkDevice: Submission thread: ",
+      submitStats.getCtr(DxvkStatCounter::QueueSubmitCount), " submissions, ",
+      submitStats.getCtr(DxvkStatCounter::QueueSubmitTime), " us submitting, ",
+      submitStats.getCtr(DxvkStatCounter::QueueEnqueueTime), " us queueing"));
+    
+    if (m_memoryLogInterval.count() != 0)
+      m_memory->logStats();
   }
   
   
@@ -46,47 +104,66 @@ namespace dxvk {
   }
   
   
-  Rc<DxvkStagingBuffer> DxvkDevice::allocStagingBuffer(VkDeviceSize size) {
-    // In case we need a standard-size staging buffer, try
-    // to recycle an old one that has been returned earlier
-    if (size <= DefaultStagingBufferSize) {
-      const Rc<DxvkStagingBuffer> buffer
-        = m_recycledStagingBuffers.retrieveObject();
-      
-      if (buffer != nullptr)
-        return buffer;
-    }
+  Rc<DxvkCsChunk> DxvkDevice::allocCsChunk(DxvkCsChunkFlags flags) {
+    Rc<DxvkCsChunk> chunk = m_recycledCsChunks.retrieveObject();
     
-    // Staging buffers only need to be able to handle transfer
-    // operations, and they need to be in host-visible memory.
-    DxvkBufferCreateInfo info;
-    info.size   = size;
-    info.usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-    info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT
-                | VK_PIPELINE_STAGE_HOST_BIT;
-    info.access = VK_ACCESS_TRANSFER_READ_BIT
-                | VK_ACCESS_HOST_WRITE_BIT;
-    
-    VkMemoryPropertyFlags memFlags
-      = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
-      | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    if (chunk != nullptr) {
+      m_csChunkPoolHits += 1;
+    } else {
+      m_csChunkPoolMisses += 1;
+      chunk = new DxvkCsChunk();
+    }
     
-    // Don't create buffers that are too small. A staging
-    // buffer should be able to serve multiple uploads.
-    if (info.size < DefaultStagingBufferSize)
-      info.size = DefaultStagingBufferSize;
+    chunk->setFlags(flags);
+    return chunk;
+  }
+  
+  
+  DxvkStatCounters DxvkDevice::getStatCounters() {
+    DxvkStatCounters result;
+    result.setCtr(DxvkStatCounter::CsChunkPoolHits,    m_csChunkPoolHits.load());
+    result.setCtr(DxvkStatCounter::CsChunkPoolMisses,  m_csChunkPoolMisses.load());
+    result.setCtr(DxvkStatCounter::BufferRenameCount,  m_bufferRenames.load());
+    result.setCtr(DxvkStatCounter::BufferReallocCount, m_bufferReallocs.load());
+    result.setCtr(DxvkStatCounter::DescSetCacheHits,   m_descSetHits.load());
+    result.setCtr(DxvkStatCounter::DescSetCacheMisses, m_descSetMisses.load());
+    result.merge(m_submissionQueue.getStatCounters());
+    result.merge(m_memory->getStatCounters());
+    result.merge(m_defragmenter.getStatCounters());
+    result.merge(m_stagingRing.getStatCounters());
+    return result;
+  }
+  
+  
+  std::vector<DxvkMemoryStats> DxvkDevice::getMemoryStats() {
+    return m_memory->getStats();
+  }
+  
+  
+  bool DxvkDevice::registerBuffer(DxvkBuffer* buffer) {
+    if (!m_options.test(DxvkOption::DefragmentMemory))
+      return false;
     
-    return new DxvkStagingBuffer(this->createBuffer(info, memFlags));
+    m_defragmenter.registerBuffer(buffer);
+    return true;
   }
   
   
-  void DxvkDevice::recycleStagingBuffer(const Rc<DxvkStagingBuffer>& buffer) {
-    // Drop staging buffers that are bigger than the
-    // standard ones to save memory, recycle the rest
-    if (buffer->size() == DefaultStagingBufferSize) {
-      m_recycledStagingBuffers.returnObject(buffer);
-      buffer->reset();
-    }
+  void DxvkDevice::unregisterBuffer(DxvkBuffer* buffer) {
+    m_defragmenter.unregisterBuffer(buffer);
+  }
+  
+  
+  uint64_t DxvkDevice::getDefragSerial() {
+    return m_defragmenter.serial();
+  }
+  
+  
+  void DxvkDevice::defragmentMemory(
+          DxvkContext*              ctx,
+          uint64_t                  serial) {
+    if (m_options.test(DxvkOption::DefragmentMemory))
+      m_defragmenter.run(ctx, serial);
   }
   
   
@@ -102,6 +179,18 @@ namespace dxvk {
   }
   
   
+  Rc<DxvkCommandList> DxvkDevice::createTransferCommandList() {
+    Rc<DxvkCommandList> cmdList = m_recycledTransferLists.retrieveObject();
+    
+    if (cmdList == nullptr) {
+      cmdList = new DxvkCommandList(m_vkd,
+        this, m_adapter->transferQueueFamily());
+    }
+    
+    return cmdList;
+  }
+  
+  
   Rc<DxvkContext> DxvkDevice::createContext() {
     return new DxvkContext(this);
   }
@@ -204,6 +293,24 @@ namespace dxvk {
   
   VkResult DxvkDevice::presentSwapImage(
     const VkPresentInfoKHR&         presentInfo) {
+    // The semaphores that the present operation waits
+    // on must be signaled by a submitted command list
+    m_submissionQueue.synchronize();
+    const uint64_t frameId = ++m_frameId;
+    
+    m_stagingRing.endFrame(frameId);
+    m_uniformRing.endFrame(frameId);
+    m_memory->releaseExpiredChunks();
+    
+    if (m_memoryLogInterval.count() != 0) {
+      const auto now = DxvkMemoryClock::now();
+      
+      if (now - m_memoryLogTime >= m_memoryLogInterval) {
+        m_memory->logStats();
+        m_memoryLogTime = now;
+      }
+    }
+    
     std::lock_guard<std::mutex> lock(m_submissionLock);
     return m_vkd->vkQueuePresentKHR(m_presentQueue, &presentInfo);
   }
@@ -228,26 +335,59 @@ namespace dxvk {
       commandList->trackResource(wakeSync);
     }
     
-    { // Queue submissions are not thread safe
-      std::lock_guard<std::mutex> lock(m_submissionLock);
-      commandList->submit(m_graphicsQueue,
-        waitSemaphore, wakeSemaphore, fence->handle());
+    // The actual submission is done on the submission
+    // thread so that the calling thread does not block
+    m_submissionQueue.submit({ m_graphicsQueue, fence,
+      commandList, waitSemaphore, wakeSemaphore });
+    return fence;
+  }
+  
+  
+  Rc<DxvkFence> DxvkDevice::submitTransferCommandList(
+    const Rc<DxvkCommandList>&      commandList,
+    const Rc<DxvkSemaphore>&        wakeSync) {
+    Rc<DxvkFence> fence = new DxvkFence(m_vkd);
+    
+    VkSemaphore wakeSemaphore = VK_NULL_HANDLE;
+    
+    if (wakeSync != nullptr) {
+      wakeSemaphore = wakeSync->handle();
+      commandList->trackResource(wakeSync);
     }
     
-    // Add this to the set of running submissions
-    m_submissionQueue.submit(fence, commandList);
+    m_submissionQueue.submit({ m_transferQueue, fence,
+      commandList, VK_NULL_HANDLE, wakeSemaphore });
     return fence;
   }
   
   
   void DxvkDevice::waitForIdle() {
+    m_submissionQueue.synchronize();
+    
+    // Waiting for the device requires access
+    // to all queues to be externally synchronized
+    std::lock_guard<std::mutex> lock(m_submissionLock);
+    
     if (m_vkd->vkDeviceWaitIdle(m_vkd->device()) != VK_SUCCESS)
       Logger::err("DxvkDevice: waitForIdle: Operation failed");
   }
   
   
+  void DxvkDevice::waitForResource(const Rc<DxvkResource>& resource) {
+    m_submissionQueue.waitForResource(resource);
+  }
+  
+  
   void DxvkDevice::recycleCommandList(const Rc<DxvkCommandList>& cmdList) {
-    m_recycledCommandLists.returnObject(cmdList);
+    if (cmdList->queueFamily() == m_adapter->graphicsQueueFamily())
+      m_recycledCommandLists.returnObject(cmdList);
+    else
+      m_recycledTransferLists.returnObject(cmdList);
+  }
+  
+  
+  void DxvkDevice::recycleCsChunk(const Rc<DxvkCsChunk>& chunk) {
+    m_recycledCsChunks.returnObject(chunk);
   }
   
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "dxvk_compute.h"
 #include "dxvk_constant_state.h"
 #include "dxvk_context.h"
+#include "dxvk_cs.h"
+#include "dxvk_defrag.h"
 #include "dxvk_extensions.h"
 #include "dxvk_framebuffer.h"
 #include "dxvk_image.h"
@@ -13,14 +15,19 @@
 #include "dxvk_pipecache.h"
 #include "dxvk_pipemanager.h"
 #include "dxvk_queue.h"
+#include "dxvk_recorder.h"
 #include "dxvk_query_pool.h"
 #include "dxvk_recycler.h"
 #include "dxvk_renderpass.h"
 #include "dxvk_sampler.h"
 #include "dxvk_shader.h"
+#include "dxvk_staging.h"
+#include "dxvk_stats.h"
 #include "dxvk_swapchain.h"
 #include "dxvk_sync.h"
 #include "dxvk_unbound.h"
+#include "dxvk_uniform_ring.h"
+#include "dxvk_upload.h"
 
 namespace dxvk {
   
@@ -36,9 +43,10 @@ namespace dxvk {
    */
   class DxvkDevice : public RcObject {
     friend class DxvkContext;
+    friend class DxvkCsThread;
+    friend class DxvkDefragmenter;
     friend class DxvkSubmissionQueue;
     
-    constexpr static VkDeviceSize DefaultStagingBufferSize = 4 * 1024 * 1024;
   public:
     
     DxvkDevice(
@@ -102,6 +110,14 @@ namespace dxvk {
       return m_features;
     }
     
+    /**
+     * \brief Device properties
+     * \returns Device properties and limits
+     */
+    const VkPhysicalDeviceProperties& properties() const {
+      return m_properties;
+    }
+    
     /**
      * \brief Allocates a physical buffer
      * 
@@ -113,28 +129,168 @@ namespace dxvk {
       const DxvkBufferCreateInfo& createInfo,
             VkMemoryPropertyFlags memoryType);
     
+    /**
+     * \brief Allocates a uniform buffer slice
+     * 
+     * Sub-allocates a slice from the device's uniform
+     * buffer ring. Can be used to replace the backing
+     * storage of small, frequently discarded uniform
+     * buffers via \ref DxvkContext::invalidateBuffer.
+     * \param [in] size Slice size, in bytes
+     * \param [out] slice The buffer slice
+     * \returns \c true on success, \c false if the
+     *          ring has no space left
+     */
+    bool allocUniformSlice(
+            VkDeviceSize              size,
+            DxvkPhysicalBufferSlice&  slice) {
+      return m_uniformRing.alloc(size, slice);
+    }
+    
     /**
      * \brief Allocates a staging buffer
      * 
-     * Returns a staging buffer that is at least as large
-     * as the requested size. It is usually bigger so that
-     * a single staging buffer may serve multiple allocations.
+     * Returns a staging buffer from the device's staging
+     * ring that is at least as large as the requested size.
+     * It is usually bigger so that a single staging buffer
+     * may serve multiple allocations. The buffer can be
+     * reused once the last reference to it is dropped.
      * \param [in] size Minimum buffer size
      * \returns The staging buffer
      */
     Rc<DxvkStagingBuffer> allocStagingBuffer(
-            VkDeviceSize size);
+            VkDeviceSize size) {
+      return m_stagingRing.acquire(size);
+    }
     
     /**
-     * \brief Recycles a staging buffer
+     * \brief Counts staged bytes
      * 
-     * When a staging buffer is no longer needed, it should
-     * be returned to the device so that it can be reused
-     * for subsequent allocations.
+     * Used for upload statistics.
+     * \param [in] size Number of bytes staged
+     */
+    void countStagedBytes(
+            VkDeviceSize size) {
+      m_stagingRing.countStagedBytes(size);
+    }
+    
+    /**
+     * \brief Allocates a command chunk
+     * 
+     * Tries to reuse a chunk that has previously been
+     * executed by a CS thread before allocating a new
+     * one. Chunks flagged as single-use are returned
+     * to the pool automatically after execution.
+     * \param [in] flags Chunk flags
+     * \returns An empty command chunk
+     */
+    Rc<DxvkCsChunk> allocCsChunk(
+            DxvkCsChunkFlags          flags);
+    
+    /**
+     * \brief Retrieves stat counters
+     * 
+     * Can be used by the HUD or client APIs
+     * to display or log internal statistics.
+     * \returns Current stat counter values
+     */
+    DxvkStatCounters getStatCounters();
+    
+    /**
+     * \brief Retrieves memory statistics
+     * 
+     * Queries allocation statistics for each memory
+     * type. This locks all memory heaps, so it should
+     * not be called more than a few times per second.
+     * \returns Statistics, indexed by memory type
+     */
+    std::vector<DxvkMemoryStats> getMemoryStats();
+    
+    /**
+     * \brief Current frame number
+     * 
+     * Incremented every time a swap chain image gets
+     * presented. Used by buffers to measure how often
+     * they get discarded per frame.
+     * \returns Number of frames presented so far
+     */
+    uint64_t getCurrentFrameId() const {
+      return m_frameId.load();
+    }
+    
+    /**
+     * \brief Counts buffer discards
+     * 
+     * Called by buffers when a discard operation has
+     * been served from the buffer's renaming pool, or
+     * when a new backing buffer had to be allocated.
+     * \param [in] renames Number of renamed slices
+     * \param [in] reallocs Number of backing buffers allocated
+     */
+    void countBufferDiscards(
+            uint32_t                  renames,
+            uint32_t                  reallocs) {
+      m_bufferRenames  += renames;
+      m_bufferReallocs += reallocs;
+    }
+    
+    /**
+     * \brief Counts descriptor set cache lookups
+     * 
+     * Called by command lists when they get reset, since
+     * the descriptor set cache is local to a command list.
+     * \param [in] hits Number of descriptor sets reused
+     * \param [in] misses Number of descriptor sets written
+     */
+    void countDescriptorSets(
+            uint64_t                  hits,
+            uint64_t                  misses) {
+      m_descSetHits   += hits;
+      m_descSetMisses += misses;
+    }
+    
+    /**
+     * \brief Registers a buffer for defragmentation
+     * 
+     * Called by buffers which are never mapped, and thus
+     * can be moved to a different memory location.
      * \param [in] buffer The buffer
+     * \returns \c true if the buffer has been registered
+     *          and must be unregistered on destruction.
      */
-    void recycleStagingBuffer(
-      const Rc<DxvkStagingBuffer>& buffer);
+    bool registerBuffer(DxvkBuffer* buffer);
+    
+    /**
+     * \brief Unregisters a buffer
+     * \param [in] buffer The buffer
+     */
+    void unregisterBuffer(DxvkBuffer* buffer);
+    
+    /**
+     * \brief Buffer serial number for defragmentation
+     * 
+     * Must be queried after the initial data for all
+     * resources created so far has been submitted, and
+     * passed to the corresponding \ref defragmentMemory
+     * call. Newer buffers will not be moved.
+     * \returns Current buffer serial number
+     */
+    uint64_t getDefragSerial();
+    
+    /**
+     * \brief Defragments device memory
+     * 
+     * Moves a limited number of buffers out of sparsely
+     * used memory chunks. Does nothing unless memory
+     * defragmentation is enabled. Should be called
+     * once per frame from the thread that executes
+     * rendering commands.
+     * \param [in] ctx Context to record commands into
+     * \param [in] serial Buffer serial number
+     */
+    void defragmentMemory(
+            DxvkContext*              ctx,
+            uint64_t                  serial);
     
     /**
      * \brief Creates a command list
@@ -142,6 +298,15 @@ namespace dxvk {
      */
     Rc<DxvkCommandList> createCommandList();
     
+    /**
+     * \brief Creates a transfer command list
+     * 
+     * The command list can only be submitted to the
+     * transfer queue, see \ref submitTransferCommandList.
+     * \returns The command list
+     */
+    Rc<DxvkCommandList> createTransferCommandList();
+    
     /**
      * \brief Creates a context
      * 
@@ -318,6 +483,87 @@ namespace dxvk {
       const Rc<DxvkSemaphore>&        waitSync,
       const Rc<DxvkSemaphore>&        wakeSync);
     
+    /**
+     * \brief Submits a transfer command list
+     * 
+     * Submits the command list to the dedicated transfer
+     * queue. Submissions are processed in order, so the
+     * semaphore can be waited on by any command list
+     * that is submitted to the graphics queue later on.
+     * \param [in] commandList The command list to submit
+     * \param [in] wakeSync Semaphore to notify
+     * \returns Synchronization fence
+     */
+    Rc<DxvkFence> submitTransferCommandList(
+      const Rc<DxvkCommandList>&      commandList,
+      const Rc<DxvkSemaphore>&        wakeSync);
+    
+    /**
+     * \brief Allocates staging memory for uploads
+     * 
+     * Thread-safe. The returned slice can be filled by the
+     * calling thread without any further synchronization,
+     * and then be used as the source of copy commands.
+     * \param [in] size Number of bytes to allocate
+     * \returns Host-visible buffer slice
+     */
+    DxvkBufferSlice allocStagingData(
+            VkDeviceSize size) {
+      return m_stagingData.alloc(size);
+    }
+    
+    /**
+     * \brief Uploads initial buffer data
+     * 
+     * Uploads the data on the transfer queue. Only valid
+     * if the \c AsyncTransfer option is enabled, and only
+     * for buffers which are not yet in use by the GPU.
+     * Uploads become visible to the graphics queue after
+     * the next call to \ref flushUploads.
+     * \param [in] buffer The buffer to write to
+     * \param [in] offset Offset of the region to update
+     * \param [in] size Size of the region to update
+     * \param [in] source Slice holding the data, see
+     *        \ref allocStagingData
+     */
+    void uploadBuffer(
+      const Rc<DxvkBuffer>&           buffer,
+            VkDeviceSize              offset,
+            VkDeviceSize              size,
+      const DxvkBufferSlice&          source) {
+      m_uploader.uploadBuffer(buffer, offset, size, source);
+    }
+    
+    /**
+     * \brief Uploads initial image data
+     * 
+     * Writes an entire mip level of the given array layers
+     * on the transfer queue. The same restrictions as for
+     * \ref uploadBuffer apply.
+     * \param [in] image The image to write to
+     * \param [in] subresources Subresources to update
+     * \param [in] source Slice holding the tightly
+     *        packed pixels or blocks
+     */
+    void uploadImage(
+      const Rc<DxvkImage>&            image,
+      const VkImageSubresourceLayers& subresources,
+      const DxvkBufferSlice&          source) {
+      m_uploader.uploadImage(image, subresources, source);
+    }
+    
+    /**
+     * \brief Submits pending uploads
+     * 
+     * Must be called before submitting any command
+     * list that uses resources which have been
+     * initialized with \ref uploadBuffer or
+     * \ref uploadImage.
+     */
+    void flushUploads() {
+      m_uploader.flush();
+    }
+    
     /**
      * \brief Waits until the device becomes idle
      * 
@@ -328,12 +574,24 @@ namespace dxvk {
      */
     void waitForIdle();
     
+    /**
+     * \brief Waits until a resource is no longer in use
+     * 
+     * Blocks the calling thread until all submitted
+     * command lists that use the resource have been
+     * executed. The resource must not be used by any
+     * command list that has not been submitted yet.
+     * \param [in] resource The resource to wait for
+     */
+    void waitForResource(const Rc<DxvkResource>& resource);
+    
   private:
     
-    Rc<DxvkAdapter>           m_adapter;
-    Rc<vk::DeviceFn>          m_vkd;
-    Rc<DxvkDeviceExtensions>  m_extensions;
-    VkPhysicalDeviceFeatures  m_features;
+    Rc<DxvkAdapter>             m_adapter;
+    Rc<vk::DeviceFn>            m_vkd;
+    Rc<DxvkDeviceExtensions>    m_extensions;
+    VkPhysicalDeviceFeatures    m_features;
+    VkPhysicalDeviceProperties  m_properties;
     
     Rc<DxvkMemoryAllocator>   m_memory;
     Rc<DxvkRenderPassPool>    m_renderPassPool;
@@ -346,15 +604,36 @@ namespace dxvk {
     std::mutex m_submissionLock;
     VkQueue m_graphicsQueue = VK_NULL_HANDLE;
     VkQueue m_presentQueue  = VK_NULL_HANDLE;
+    VkQueue m_transferQueue = VK_NULL_HANDLE;
     
     DxvkRecycler<DxvkCommandList,  16> m_recycledCommandLists;
-    DxvkRecycler<DxvkStagingBuffer, 4> m_recycledStagingBuffers;
-    
-    DxvkSubmissionQueue m_submissionQueue;
+    DxvkRecycler<DxvkCommandList,   4> m_recycledTransferLists;
+    DxvkRecycler<DxvkCsChunk,      64> m_recycledCsChunks;
+    
+    std::atomic<uint64_t> m_csChunkPoolHits   = { 0ull };
+    std::atomic<uint64_t> m_csChunkPoolMisses = { 0ull };
+    std::atomic<uint64_t> m_bufferRenames     = { 0ull };
+    std::atomic<uint64_t> m_bufferReallocs    = { 0ull };
+    std::atomic<uint64_t> m_descSetHits       = { 0ull };
+    std::atomic<uint64_t> m_descSetMisses     = { 0ull };
+    std::atomic<uint64_t> m_frameId           = { 0ull };
+    
+    std::chrono::seconds        m_memoryLogInterval = std::chrono::seconds(0);
+    DxvkMemoryClock::time_point m_memoryLogTime;
+    
+    DxvkDefragmenter      m_defragmenter;
+    DxvkUniformRing       m_uniformRing;
+    DxvkStagingRing       m_stagingRing;
+    DxvkStagingDataAlloc  m_stagingData;
+    DxvkUploader          m_uploader;
+    DxvkSubmissionQueue   m_submissionQueue;
     
     void recycleCommandList(
       const Rc<DxvkCommandList>& cmdList);
     
+    void recycleCsChunk(
+      const Rc<DxvkCsChunk>& chunk);
+    
     /**
      * \brief Dummy buffer handle
      * \returns Use for unbound vertex buffers.
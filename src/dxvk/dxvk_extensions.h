@@ -129,11 +129,14 @@ namespace dxvk {
    * used by DXVK if supported by the implementation.
    */
   struct DxvkDeviceExtensions : public DxvkExtensionList {
-    DxvkExtension amdRasterizationOrder   = { this, VK_AMD_RASTERIZATION_ORDER_EXTENSION_NAME,    DxvkExtensionType::Optional };
-    DxvkExtension khrMaintenance1         = { this, VK_KHR_MAINTENANCE1_EXTENSION_NAME,           DxvkExtensionType::Required };
-    DxvkExtension khrMaintenance2         = { this, VK_KHR_MAINTENANCE2_EXTENSION_NAME,           DxvkExtensionType::Desired  };
-    DxvkExtension khrShaderDrawParameters = { this, VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME, DxvkExtensionType::Required };
-    DxvkExtension khrSwapchain            = { this, VK_KHR_SWAPCHAIN_EXTENSION_NAME,              DxvkExtensionType::Required };
+    DxvkExtension amdRasterizationOrder       = { this, VK_AMD_RASTERIZATION_ORDER_EXTENSION_NAME,        DxvkExtensionType::Optional };
+    DxvkExtension khrDedicatedAllocation      = { this, VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME,       DxvkExtensionType::Optional };
+    DxvkExtension khrDescriptorUpdateTemplate = { this, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, DxvkExtensionType::Optional };
+    DxvkExtension khrGetMemoryRequirements2   = { this, VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME,  DxvkExtensionType::Optional };
+    DxvkExtension khrMaintenance1             = { this, VK_KHR_MAINTENANCE1_EXTENSION_NAME,               DxvkExtensionType::Required };
+    DxvkExtension khrMaintenance2             = { this, VK_KHR_MAINTENANCE2_EXTENSION_NAME,               DxvkExtensionType::Desired  };
+    DxvkExtension khrShaderDrawParameters     = { this, VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME,     DxvkExtensionType::Required };
+    DxvkExtension khrSwapchain                = { this, VK_KHR_SWAPCHAIN_EXTENSION_NAME,                  DxvkExtensionType::Required };
   };
   
 }
\ No newline at end of file
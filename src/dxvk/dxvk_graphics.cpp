@@ -50,9 +50,13 @@ namespace dxvk {
     if (gs  != nullptr) gs ->defineResourceSlots(slotMapping);
     if (fs  != nullptr) fs ->defineResourceSlots(slotMapping);
     
+    slotMapping.makeDescriptorsDynamic(
+      device->properties().limits.maxDescriptorSetUniformBuffersDynamic);
+    
     m_layout = new DxvkPipelineLayout(m_vkd,
       slotMapping.bindingCount(),
-      slotMapping.bindingInfos());
+      slotMapping.bindingInfos(),
+      device->extensions().khrDescriptorUpdateTemplate.enabled());
     
     if (vs  != nullptr) m_vs  = vs ->createShaderModule(m_vkd, slotMapping);
     if (tcs != nullptr) m_tcs = tcs->createShaderModule(m_vkd, slotMapping);
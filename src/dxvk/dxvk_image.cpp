@@ -30,11 +30,40 @@ namespace dxvk {
           &info, nullptr, &m_image) != VK_SUCCESS)
       throw DxvkError("DxvkImage::DxvkImage: Failed to create image");
     
-    VkMemoryRequirements memReq;
-    m_vkd->vkGetImageMemoryRequirements(
-      m_vkd->device(), m_image, &memReq);
+    VkMemoryDedicatedRequirementsKHR dedicatedRequirements;
+    dedicatedRequirements.sType                       = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR;
+    dedicatedRequirements.pNext                       = nullptr;
+    dedicatedRequirements.prefersDedicatedAllocation  = VK_FALSE;
+    dedicatedRequirements.requiresDedicatedAllocation = VK_FALSE;
     
-    m_memory = memAlloc.alloc(memReq, memFlags);
+    VkMemoryRequirements2KHR memReq;
+    memReq.sType = VK_STRUCTURE_TYPE_MEMORY_REQUIREMENTS_2_KHR;
+    memReq.pNext = &dedicatedRequirements;
+    
+    // Render targets and large images may perform better
+    // in their own allocation, so ask the driver about it
+    if (memAlloc.supportsDedicatedAllocation()) {
+      VkImageMemoryRequirementsInfo2KHR memReqInfo;
+      memReqInfo.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_REQUIREMENTS_INFO_2_KHR;
+      memReqInfo.pNext = nullptr;
+      memReqInfo.image = m_image;
+      
+      m_vkd->vkGetImageMemoryRequirements2KHR(
+        m_vkd->device(), &memReqInfo, &memReq);
+    } else {
+      m_vkd->vkGetImageMemoryRequirements(
+        m_vkd->device(), m_image, &memReq.memoryRequirements);
+    }
+    
+    VkMemoryDedicatedAllocateInfoKHR dedMemoryAllocInfo;
+    dedMemoryAllocInfo.sType  = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO_KHR;
+    dedMemoryAllocInfo.pNext  = nullptr;
+    dedMemoryAllocInfo.image  = m_image;
+    dedMemoryAllocInfo.buffer = VK_NULL_HANDLE;
+    
+    m_memory = memAlloc.alloc(memReq.memoryRequirements,
+      dedicatedRequirements, dedMemoryAllocInfo, memFlags,
+      DxvkMemoryPriority::Normal);
     
     if (m_vkd->vkBindImageMemory(m_vkd->device(),
           m_image, m_memory.memory(), m_memory.offset()) != VK_SUCCESS)
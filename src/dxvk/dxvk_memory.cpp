@@ -1,3 +1,6 @@
+#include <cstdlib>
+#include <thread>
+
 #include "dxvk_memory.h"
 
 namespace dxvk {
@@ -13,13 +16,17 @@ namespace dxvk {
           VkDeviceMemory    memory,
           VkDeviceSize      offset,
           VkDeviceSize      length,
-          void*             mapPtr)
+          void*             mapPtr,
+          uint32_t          block,
+          bool              driverDedicated)
   : m_chunk   (chunk),
     m_heap    (heap),
     m_memory  (memory),
     m_offset  (offset),
     m_length  (length),
-    m_mapPtr  (mapPtr) { }
+    m_mapPtr  (mapPtr),
+    m_block   (block),
+    m_driverDedicated(driverDedicated) { }
   
   
   DxvkMemory::DxvkMemory(DxvkMemory&& other)
@@ -28,25 +35,41 @@ namespace dxvk {
     m_memory  (std::exchange(other.m_memory, VkDeviceMemory(VK_NULL_HANDLE))),
     m_offset  (std::exchange(other.m_offset, 0)),
     m_length  (std::exchange(other.m_length, 0)),
-    m_mapPtr  (std::exchange(other.m_mapPtr, nullptr)) { }
+    m_mapPtr  (std::exchange(other.m_mapPtr, nullptr)),
+    m_block   (std::exchange(other.m_block,  0u)),
+    m_driverDedicated(std::exchange(other.m_driverDedicated, false)) { }
   
   
   DxvkMemory& DxvkMemory::operator = (DxvkMemory&& other) {
+    this->free();
     m_chunk   = std::exchange(other.m_chunk,  nullptr);
     m_heap    = std::exchange(other.m_heap,   nullptr);
     m_memory  = std::exchange(other.m_memory, VkDeviceMemory(VK_NULL_HANDLE));
     m_offset  = std::exchange(other.m_offset, 0);
     m_length  = std::exchange(other.m_length, 0);
     m_mapPtr  = std::exchange(other.m_mapPtr, nullptr);
+    m_block   = std::exchange(other.m_block,  0u);
+    m_driverDedicated = std::exchange(other.m_driverDedicated, false);
     return *this;
   }
   
   
   DxvkMemory::~DxvkMemory() {
+    this->free();
+  }
+  
+  
+  bool DxvkMemory::isEvacuating() const {
+    return m_chunk != nullptr
+        && m_chunk->isEvacuating();
+  }
+  
+  
+  void DxvkMemory::free() {
     if (m_chunk != nullptr)
-      m_heap->free(m_chunk, m_offset, m_length);
+      m_heap->free(m_chunk, m_block);
     else if (m_heap != nullptr)
-      m_heap->freeDeviceMemory(m_memory);
+      m_heap->freeDedicatedMemory(m_memory, m_length, m_driverDedicated);
   }
   
 
@@ -59,96 +82,312 @@ namespace dxvk {
     m_memory(memory),
     m_mapPtr(mapPtr),
     m_size  (size) {
+    m_slBitmaps.fill(0);
+    m_freeLists.fill(NullBlock);
+    
     // Mark the entire chunk as free
-    m_freeList.push_back(FreeSlice { 0, size });
+    this->insertFreeBlock(this->createBlock(0, size));
+    m_emptySince = DxvkMemoryClock::now();
   }
   
   
   DxvkMemoryChunk::~DxvkMemoryChunk() {
-    m_heap->freeDeviceMemory(m_memory);
+    m_heap->freeDeviceMemory(m_memory, m_size);
   }
   
   
   DxvkMemory DxvkMemoryChunk::alloc(VkDeviceSize size, VkDeviceSize align) {
-    // If the chunk is full, return
-    if (m_freeList.size() == 0)
-      return DxvkMemory();
+    const VkDeviceSize length = dxvk::align(size, align);
     
-    // Select the slice to allocate from in a worst-fit
-    // manner. This may help keep fragmentation low.
-    auto bestSlice = m_freeList.begin();
+    // Any block from the selected list is large enough to
+    // hold the allocation, but we may have to skip a few
+    // bytes at the start to satisfy alignment requirements.
+    // If that fails, pick a list that accounts for that.
+    uint32_t index = this->findFreeBlock(length);
     
-    for (auto slice = m_freeList.begin(); slice != m_freeList.end(); slice++) {
-      if (slice->length == size) {
-        bestSlice = slice;
-        break;
-      } else if (slice->length > bestSlice->length) {
-        bestSlice = slice;
-      }
+    if (index != NullBlock) {
+      const Block& block = m_blocks[index];
+      
+      const VkDeviceSize allocStart = dxvk::align(block.offset, align);
+      
+      if (allocStart + length > block.offset + block.length)
+        index = this->findFreeBlock(length + align - 1);
     }
     
-    // We need to align the allocation to the requested alignment
-    const VkDeviceSize sliceStart = bestSlice->offset;
-    const VkDeviceSize sliceEnd   = bestSlice->offset + bestSlice->length;
+    if (index == NullBlock)
+      return DxvkMemory();
     
-    const VkDeviceSize allocStart = dxvk::align(sliceStart,        align);
-    const VkDeviceSize allocEnd   = dxvk::align(allocStart + size, align);
+    this->removeFreeBlock(index);
     
-    if (allocEnd > sliceEnd)
-      return DxvkMemory();
+    const VkDeviceSize sliceStart = m_blocks[index].offset;
+    const VkDeviceSize sliceEnd   = m_blocks[index].offset + m_blocks[index].length;
+    
+    const VkDeviceSize allocStart = dxvk::align(sliceStart, align);
+    const VkDeviceSize allocEnd   = allocStart + length;
+    
+    // Return the unused parts of the block to the free lists.
+    // The physical neighbours of a free block are never free,
+    // so these new blocks do not need to be merged with them.
+    if (allocStart != sliceStart) {
+      const uint32_t prev = this->createBlock(sliceStart, allocStart - sliceStart);
+      
+      m_blocks[prev].prevPhys = m_blocks[index].prevPhys;
+      m_blocks[prev].nextPhys = index;
+      
+      if (m_blocks[index].prevPhys != NullBlock)
+        m_blocks[m_blocks[index].prevPhys].nextPhys = prev;
+      
+      m_blocks[index].prevPhys = prev;
+      this->insertFreeBlock(prev);
+    }
     
-    // We can use this slice, but we'll have to add
-    // the unused parts of it back to the free list.
-    m_freeList.erase(bestSlice);
+    if (allocEnd != sliceEnd) {
+      const uint32_t next = this->createBlock(allocEnd, sliceEnd - allocEnd);
+      
+      m_blocks[next].prevPhys = index;
+      m_blocks[next].nextPhys = m_blocks[index].nextPhys;
+      
+      if (m_blocks[index].nextPhys != NullBlock)
+        m_blocks[m_blocks[index].nextPhys].prevPhys = next;
+      
+      m_blocks[index].nextPhys = next;
+      this->insertFreeBlock(next);
+    }
     
-    if (allocStart != sliceStart)
-      m_freeList.push_back({ sliceStart, allocStart - sliceStart });
+    m_blocks[index].offset = allocStart;
+    m_blocks[index].length = length;
     
-    if (allocEnd != sliceEnd)
-      m_freeList.push_back({ allocEnd, sliceEnd - allocEnd });
+    m_used += length;
     
-    // Create the memory object with the aligned slice
+    // Create the memory object with the aligned slice. The
+    // block index is passed back to us when it gets freed.
     m_delta++;
     return DxvkMemory(this, m_heap,
-      m_memory, allocStart, allocEnd - allocStart,
-      reinterpret_cast<char*>(m_mapPtr) + allocStart);
+      m_memory, allocStart, length,
+      reinterpret_cast<char*>(m_mapPtr) + allocStart, index);
   }
   
   
   void DxvkMemoryChunk::free(
+          uint32_t      index) {
+    if (index >= m_blocks.size() || m_blocks[index].isFree) {
+      Logger::err("DxvkMemoryChunk: Invalid free");
+      return;
+    }
+    
+    m_used -= m_blocks[index].length;
+    
+    // Merge the block with adjacent free blocks. Without
+    // doing so, the memory could not be reused for larger
+    // allocations and the free lists would keep growing.
+    const uint32_t prev = m_blocks[index].prevPhys;
+    const uint32_t next = m_blocks[index].nextPhys;
+    
+    if (next != NullBlock && m_blocks[next].isFree) {
+      this->removeFreeBlock(next);
+      
+      m_blocks[index].length  += m_blocks[next].length;
+      m_blocks[index].nextPhys = m_blocks[next].nextPhys;
+      
+      if (m_blocks[next].nextPhys != NullBlock)
+        m_blocks[m_blocks[next].nextPhys].prevPhys = index;
+      
+      this->destroyBlock(next);
+    }
+    
+    if (prev != NullBlock && m_blocks[prev].isFree) {
+      this->removeFreeBlock(prev);
+      
+      m_blocks[prev].length  += m_blocks[index].length;
+      m_blocks[prev].nextPhys = m_blocks[index].nextPhys;
+      
+      if (m_blocks[index].nextPhys != NullBlock)
+        m_blocks[m_blocks[index].nextPhys].prevPhys = prev;
+      
+      this->destroyBlock(index);
+      this->insertFreeBlock(prev);
+    } else {
+      this->insertFreeBlock(index);
+    }
+    
+    if (--m_delta == 0)
+      m_emptySince = DxvkMemoryClock::now();
+  }
+  
+  
+  void DxvkMemoryChunk::getStats(DxvkMemoryStats& stats) const {
+    stats.memoryAllocated += m_size;
+    stats.memoryUsed      += m_used;
+    stats.chunkCount      += 1;
+    
+    // Blocks within a list are not sorted by size, so we
+    // have to scan the list for the largest size class
+    if (m_flBitmap != 0) {
+      const uint32_t fl = bit::bsr(m_flBitmap);
+      const uint32_t sl = bit::bsr(m_slBitmaps[fl]);
+      
+      uint32_t index = m_freeLists[fl * SlCount + sl];
+      
+      while (index != NullBlock) {
+        stats.largestFreeBlock = std::max(
+          stats.largestFreeBlock, m_blocks[index].length);
+        index = m_blocks[index].nextFree;
+      }
+    }
+  }
+  
+  
+  uint32_t DxvkMemoryChunk::createBlock(
           VkDeviceSize  offset,
           VkDeviceSize  length) {
-    // Remove adjacent entries from the free list and then add
-    // a new slice that covers all those entries. Without doing
-    // so, the slice could not be reused for larger allocations.
-    auto curr = m_freeList.begin();
-    
-    while (curr != m_freeList.end()) {
-      if (curr->offset == offset + length) {
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else if (curr->offset + curr->length == offset) {
-        offset -= curr->length;
-        length += curr->length;
-        curr = m_freeList.erase(curr);
-      } else {
-        curr++;
-      }
+    uint32_t index = NullBlock;
+    
+    if (m_unusedBlocks.size() != 0) {
+      index = m_unusedBlocks.back();
+      m_unusedBlocks.pop_back();
+    } else {
+      index = m_blocks.size();
+      m_blocks.emplace_back();
     }
     
-    m_delta--;
-    m_freeList.push_back({ offset, length });
+    Block& block = m_blocks[index];
+    block.offset   = offset;
+    block.length   = length;
+    block.prevPhys = NullBlock;
+    block.nextPhys = NullBlock;
+    block.prevFree = NullBlock;
+    block.nextFree = NullBlock;
+    block.isFree   = false;
+    return index;
+  }
+  
+  
+  void DxvkMemoryChunk::destroyBlock(uint32_t index) {
+    m_unusedBlocks.push_back(index);
+  }
+  
+  
+  void DxvkMemoryChunk::insertFreeBlock(uint32_t index) {
+    Block& block = m_blocks[index];
+    
+    uint32_t fl, sl;
+    mapSize(block.length, fl, sl);
+    
+    uint32_t& head = m_freeLists[fl * SlCount + sl];
+    
+    block.prevFree = NullBlock;
+    block.nextFree = head;
+    block.isFree   = true;
+    
+    if (head != NullBlock)
+      m_blocks[head].prevFree = index;
+    
+    head = index;
+    
+    m_flBitmap      |= 1ull << fl;
+    m_slBitmaps[fl] |= 1u   << sl;
+  }
+  
+  
+  void DxvkMemoryChunk::removeFreeBlock(uint32_t index) {
+    Block& block = m_blocks[index];
+    
+    uint32_t fl, sl;
+    mapSize(block.length, fl, sl);
+    
+    uint32_t& head = m_freeLists[fl * SlCount + sl];
+    
+    if (block.prevFree != NullBlock)
+      m_blocks[block.prevFree].nextFree = block.nextFree;
+    
+    if (block.nextFree != NullBlock)
+      m_blocks[block.nextFree].prevFree = block.prevFree;
+    
+    if (head == index)
+      head = block.nextFree;
+    
+    if (head == NullBlock) {
+      m_slBitmaps[fl] &= ~(1u << sl);
+      
+      if (m_slBitmaps[fl] == 0)
+        m_flBitmap &= ~(1ull << fl);
+    }
+    
+    block.prevFree = NullBlock;
+    block.nextFree = NullBlock;
+    block.isFree   = false;
+  }
+  
+  
+  uint32_t DxvkMemoryChunk::findFreeBlock(VkDeviceSize length) const {
+    if (length > m_size)
+      return NullBlock;
+    
+    // Round up the size to the next size class so that
+    // every block in the selected list is large enough.
+    if (length >= SlCount)
+      length += (VkDeviceSize(1) << (bit::bsr(length) - SlBits)) - 1;
+    
+    uint32_t fl, sl;
+    mapSize(length, fl, sl);
+    
+    uint32_t slBitmap = m_slBitmaps[fl] & (~0u << sl);
+    
+    if (slBitmap == 0) {
+      const uint64_t flBitmap = fl + 1 < FlCount
+        ? m_flBitmap & (~0ull << (fl + 1))
+        : 0ull;
+      
+      if (flBitmap == 0)
+        return NullBlock;
+      
+      fl = bit::bsf(flBitmap);
+      slBitmap = m_slBitmaps[fl];
+    }
+    
+    sl = bit::bsf(slBitmap);
+    return m_freeLists[fl * SlCount + sl];
+  }
+  
+  
+  void DxvkMemoryChunk::mapSize(
+          VkDeviceSize  length,
+          uint32_t&     fl,
+          uint32_t&     sl) {
+    if (length < SlCount) {
+      fl = 0;
+      sl = uint32_t(length);
+    } else {
+      const uint32_t msb = bit::bsr(length);
+      fl = msb - SlBits + 1;
+      sl = uint32_t(length >> (msb - SlBits)) ^ SlCount;
+    }
   }
   
   
   DxvkMemoryHeap::DxvkMemoryHeap(
     const Rc<vk::DeviceFn>    vkd,
           uint32_t            memTypeId,
-          VkMemoryType        memType)
-  : m_vkd       (vkd),
-    m_memTypeId (memTypeId),
-    m_memType   (memType) {
-    
+          VkMemoryType        memType,
+          VkMemoryHeap        memHeap,
+          DxvkMemoryBudget*   budget,
+          std::chrono::milliseconds gracePeriod,
+          bool                keepSpare)
+  : m_vkd         (vkd),
+    m_memTypeId   (memTypeId),
+    m_memType     (memType),
+    m_memHeap     (memHeap),
+    m_budget      (budget),
+    m_gracePeriod (gracePeriod),
+    m_keepSpare   (keepSpare),
+    m_lastRelease (DxvkMemoryClock::now()) {
+    // Limit the chunk size relative to the heap size so
+    // that small heaps, such as host-visible VRAM, do not
+    // waste a large portion of their memory in chunks.
+    m_maxChunkSize = std::max(MinChunkSizeLimit,
+      std::min(MaxChunkSize, m_memHeap.size / 16));
+    m_minChunkSize = std::min(MinChunkSize, m_maxChunkSize);
+    m_chunkSize    = m_minChunkSize;
   }
   
   
@@ -157,49 +396,167 @@ namespace dxvk {
   }
   
   
-  DxvkMemory DxvkMemoryHeap::alloc(VkDeviceSize size, VkDeviceSize align) {
+  DxvkMemory DxvkMemoryHeap::alloc(
+          VkDeviceSize                      size,
+          VkDeviceSize                      align,
+    const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+          VkDeviceSize                      memoryLimit) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
     // We don't sub-allocate large allocations from one of the
     // chunks since that might lead to severe fragmentation.
-    if (size >= (m_chunkSize / 4)) {
-      VkDeviceMemory memory = this->allocDeviceMemory(size);
+    // Also respect the driver's wish for dedicated memory.
+    if (dedAllocInfo != nullptr || size >= (m_chunkSize / 4)) {
+      lock.unlock();
+      
+      VkDeviceMemory memory = this->allocDeviceMemory(size, dedAllocInfo, memoryLimit);
       
       if (memory == VK_NULL_HANDLE)
         return DxvkMemory();
       
+      m_dedicatedCount += 1;
+      m_dedicatedSize  += size;
+      
+      if (dedAllocInfo != nullptr)
+        m_driverDedicatedCount += 1;
+      
       return DxvkMemory(nullptr, this, memory,
-        0, size, this->mapDeviceMemory(memory));
+        0, size, this->mapDeviceMemory(memory),
+        0, dedAllocInfo != nullptr);
     } else {
-      std::lock_guard<std::mutex> lock(m_mutex);
+      this->checkEmptyChunks();
       
-      // Probe chunks in a first-fit manner
-      for (const auto& chunk : m_chunks) {
-        DxvkMemory memory = chunk->alloc(size, align);
-        
-        if (memory.memory() != VK_NULL_HANDLE)
-          return memory;
-      }
+      DxvkMemory memory = this->allocChunkMemory(size, align);
+      
+      if (memory.memory() != VK_NULL_HANDLE)
+        return memory;
       
       // None of the existing chunks could satisfy
       // the request, we need to create a new one
-      VkDeviceMemory chunkMem = this->allocDeviceMemory(m_chunkSize);
+      VkDeviceMemory chunkMem = this->allocDeviceMemory(m_chunkSize, nullptr, memoryLimit);
       
       if (chunkMem == VK_NULL_HANDLE)
         return DxvkMemory();
       
       Rc<DxvkMemoryChunk> newChunk = new DxvkMemoryChunk(this,
         chunkMem, this->mapDeviceMemory(chunkMem), m_chunkSize);
-      DxvkMemory memory = newChunk->alloc(size, align);
+      memory = newChunk->alloc(size, align);
+      
+      // Keep the chunk around even if the allocation failed,
+      // it will be released after the grace period if unused
+      if (memory.memory() == VK_NULL_HANDLE)
+        m_emptyChunks += 1;
       
       m_chunks.push_back(std::move(newChunk));
+      m_chunkMemory += m_chunkSize;
+      
+      this->updateChunkSize();
       return memory;
     }
   }
   
   
-  VkDeviceMemory DxvkMemoryHeap::allocDeviceMemory(VkDeviceSize memorySize) {
+  DxvkMemory DxvkMemoryHeap::allocFromChunks(
+          VkDeviceSize                      size,
+          VkDeviceSize                      align) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    // Large allocations would get dedicated memory
+    if (size >= (m_chunkSize / 4))
+      return DxvkMemory();
+    
+    return this->allocChunkMemory(size, align);
+  }
+  
+  
+  void DxvkMemoryHeap::trim() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->releaseEmptyChunks(DxvkMemoryClock::now(), true);
+  }
+  
+  
+  void DxvkMemoryHeap::releaseExpiredChunks() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->checkEmptyChunks();
+  }
+  
+  
+  DxvkMemoryStats DxvkMemoryHeap::getStats() {
+    DxvkMemoryStats stats;
+    stats.memoryAllocated = m_dedicatedSize.load();
+    stats.memoryUsed      = m_dedicatedSize.load();
+    stats.dedicatedCount  = m_dedicatedCount.load();
+    stats.driverDedicatedCount = m_driverDedicatedCount.load();
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (const auto& chunk : m_chunks)
+      chunk->getStats(stats);
+    
+    return stats;
+  }
+  
+  
+  uint32_t DxvkMemoryHeap::beginDefrag() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    std::vector<DxvkMemoryChunk*> candidates;
+    VkDeviceSize freeMemory = 0;
+    
+    for (const auto& chunk : m_chunks) {
+      chunk->setEvacuating(false);
+      freeMemory += chunk->size() - chunk->used();
+      
+      if (!chunk->isEmpty() && chunk->used() < chunk->size() / DefragThreshold)
+        candidates.push_back(chunk.ptr());
+    }
+    
+    std::sort(candidates.begin(), candidates.end(),
+      [] (const DxvkMemoryChunk* a, const DxvkMemoryChunk* b) {
+        return a->used() < b->used();
+      });
+    
+    uint32_t count = 0;
+    
+    for (DxvkMemoryChunk* chunk : candidates) {
+      // Free space in the evacuated chunk itself cannot
+      // be used, and the data that gets moved out of it
+      // needs some headroom since other chunks are likely
+      // fragmented as well.
+      const VkDeviceSize chunkFree = chunk->size() - chunk->used();
+      
+      if (freeMemory < chunkFree + 2 * chunk->used())
+        break;
+      
+      freeMemory -= chunkFree + chunk->used();
+      chunk->setEvacuating(true);
+      count += 1;
+    }
+    
+    return count;
+  }
+  
+  
+  void DxvkMemoryHeap::endDefrag() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (const auto& chunk : m_chunks)
+      chunk->setEvacuating(false);
+  }
+  
+  
+  VkDeviceMemory DxvkMemoryHeap::allocDeviceMemory(
+          VkDeviceSize                      memorySize,
+    const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+          VkDeviceSize                      memoryLimit) {
+    // The budget is shared with other threads, so this
+    // check is not exact, but it does not have to be.
+    if (m_budget->used.load() + memorySize > memoryLimit)
+      return VK_NULL_HANDLE;
+    
     VkMemoryAllocateInfo info;
     info.sType            = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    info.pNext            = nullptr;
+    info.pNext            = dedAllocInfo;
     info.allocationSize   = memorySize;
     info.memoryTypeIndex  = m_memTypeId;
     
@@ -209,12 +566,30 @@ namespace dxvk {
         &info, nullptr, &memory) != VK_SUCCESS)
       return VK_NULL_HANDLE;
     
+    m_budget->used += memorySize;
     return memory;
   }
   
   
-  void DxvkMemoryHeap::freeDeviceMemory(VkDeviceMemory memory) {
+  void DxvkMemoryHeap::freeDeviceMemory(
+          VkDeviceMemory  memory,
+          VkDeviceSize    memorySize) {
     m_vkd->vkFreeMemory(m_vkd->device(), memory, nullptr);
+    m_budget->used -= memorySize;
+  }
+  
+  
+  void DxvkMemoryHeap::freeDedicatedMemory(
+          VkDeviceMemory  memory,
+          VkDeviceSize    length,
+          bool            driverDedicated) {
+    m_dedicatedCount -= 1;
+    m_dedicatedSize  -= length;
+    
+    if (driverDedicated)
+      m_driverDedicatedCount -= 1;
+    
+    this->freeDeviceMemory(memory, length);
   }
   
   
@@ -236,19 +611,177 @@ namespace dxvk {
   
   void DxvkMemoryHeap::free(
           DxvkMemoryChunk*  chunk,
-          VkDeviceSize      offset,
-          VkDeviceSize      length) {
+          uint32_t          block) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    chunk->free(offset, length);
+    chunk->free(block);
+    
+    if (chunk->isEmpty()) {
+      chunk->setEvacuating(false);
+      m_emptyChunks += 1;
+    }
+    
+    this->checkEmptyChunks();
+  }
+  
+  
+  DxvkMemory DxvkMemoryHeap::allocChunkMemory(
+          VkDeviceSize    size,
+          VkDeviceSize    align) {
+    // Probe chunks in a first-fit manner
+    for (const auto& chunk : m_chunks) {
+      if (chunk->isEvacuating())
+        continue;
+      
+      const bool wasEmpty = chunk->isEmpty();
+      
+      DxvkMemory memory = chunk->alloc(size, align);
+      
+      if (memory.memory() != VK_NULL_HANDLE) {
+        if (wasEmpty)
+          m_emptyChunks -= 1;
+        return memory;
+      }
+    }
+    
+    return DxvkMemory();
+  }
+  
+  
+  void DxvkMemoryHeap::checkEmptyChunks() {
+    // Only scan the chunk list every now and then. There is
+    // no need to be precise, and games tend to free a lot of
+    // small resources every frame. The spare chunk is never
+    // released here, so a single empty chunk can be skipped.
+    if (m_emptyChunks > 1) {
+      const auto now = DxvkMemoryClock::now();
+      
+      if (now - m_lastRelease >= m_gracePeriod / 8)
+        this->releaseEmptyChunks(now, false);
+    }
+  }
+  
+  
+  void DxvkMemoryHeap::releaseEmptyChunks(
+          DxvkMemoryClock::time_point now,
+          bool            releaseSpare) {
+    bool keepSpare = m_keepSpare && !releaseSpare;
+    
+    auto chunk = m_chunks.begin();
+    
+    while (chunk != m_chunks.end()) {
+      if ((*chunk)->isEmpty()) {
+        if (keepSpare) {
+          keepSpare = false;
+        } else if (releaseSpare || now - (*chunk)->emptySince() >= m_gracePeriod) {
+          // Destroying the chunk frees the device memory
+          m_chunkMemory -= (*chunk)->size();
+          m_emptyChunks -= 1;
+          
+          chunk = m_chunks.erase(chunk);
+          continue;
+        }
+      }
+      
+      chunk++;
+    }
+    
+    m_lastRelease = now;
+    
+    this->updateChunkSize();
+  }
+  
+  
+  void DxvkMemoryHeap::updateChunkSize() {
+    // Grow the chunk size geometrically with the amount of
+    // memory allocated, so that applications which use a lot
+    // of memory don't end up with thousands of allocations.
+    VkDeviceSize chunkSize = m_minChunkSize;
+    
+    while (chunkSize < m_maxChunkSize && chunkSize < m_chunkMemory / 4)
+      chunkSize *= 2;
+    
+    m_chunkSize = chunkSize;
   }
   
   
   DxvkMemoryAllocator::DxvkMemoryAllocator(
-    const Rc<DxvkAdapter>&  adapter,
-    const Rc<vk::DeviceFn>& vkd)
-  : m_vkd(vkd), m_memProps(adapter->memoryProperties()) {
-    for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++)
-      m_heaps[i] = new DxvkMemoryHeap(m_vkd, i, m_memProps.memoryTypes[i]);
+    const Rc<DxvkAdapter>&      adapter,
+    const Rc<vk::DeviceFn>&     vkd,
+    const DxvkDeviceExtensions& extensions)
+  : m_vkd(vkd), m_memProps(adapter->memoryProperties()),
+    m_dedicatedAllocation(
+      extensions.khrDedicatedAllocation.enabled() &&
+      extensions.khrGetMemoryRequirements2.enabled()) {
+    // Time in milliseconds after which empty chunks get freed
+    std::chrono::milliseconds gracePeriod(2000);
+    
+    const std::string gracePeriodStr = env::getEnvVar(L"DXVK_MEMORY_GRACE_PERIOD");
+    
+    if (!gracePeriodStr.empty()) {
+      char* end = nullptr;
+      const unsigned long value = std::strtoul(gracePeriodStr.c_str(), &end, 10);
+      
+      if (end != gracePeriodStr.c_str() && *end == '\0')
+        gracePeriod = std::chrono::milliseconds(value);
+      else
+        Logger::warn(str::format("DxvkMemoryAllocator: Invalid grace period: ", gracePeriodStr));
+    }
+    
+    m_trimInterval = gracePeriod / 8;
+    
+    // Leave some headroom on device-local heaps since other
+    // applications and the driver itself need VRAM as well.
+    // Allocating more than that forces the driver to evict
+    // resources, which is slower than using system memory.
+    const std::string budgetStr = env::getEnvVar(L"DXVK_MEMORY_BUDGET");
+    
+    VkDeviceSize budgetOverride = 0;
+    
+    if (!budgetStr.empty()) {
+      char* end = nullptr;
+      const unsigned long long value = std::strtoull(budgetStr.c_str(), &end, 10);
+      
+      if (end != budgetStr.c_str() && *end == '\0')
+        budgetOverride = VkDeviceSize(value) << 20;
+      else
+        Logger::warn(str::format("DxvkMemoryAllocator: Invalid memory budget: ", budgetStr));
+    }
+    
+    for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
+      const VkMemoryHeap memHeap = m_memProps.memoryHeaps[i];
+      
+      VkDeviceSize budget = memHeap.size;
+      
+      if (memHeap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+        budget = memHeap.size - memHeap.size / 8;
+        
+        if (budgetOverride != 0)
+          budget = std::min(memHeap.size, budgetOverride);
+      }
+      
+      m_budgets[i].budget   = budget;
+      m_budgets[i].lowLimit = budget - budget / 4;
+    }
+    
+    // Memory types on large heaps are split into multiple
+    // stripes so that threads allocating memory at the same
+    // time do not all contend on the same lock. Each stripe
+    // has its own set of chunks, so small heaps get only one.
+    // Only the first stripe keeps a spare chunk, since other
+    // stripes can allocate from it before growing their heap.
+    const uint32_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+      const VkMemoryType memType = m_memProps.memoryTypes[i];
+      const VkMemoryHeap memHeap = m_memProps.memoryHeaps[memType.heapIndex];
+      
+      const uint32_t numStripes = std::min(numThreads, uint32_t(
+        std::clamp<VkDeviceSize>(memHeap.size / StripeHeapSize, 1, MaxNumStripes)));
+      
+      for (uint32_t j = 0; j < numStripes; j++)
+        m_heaps[i].push_back(new DxvkMemoryHeap(m_vkd, i, memType, memHeap,
+          &m_budgets[memType.heapIndex], gracePeriod, j == 0));
+    }
   }
   
   
@@ -260,12 +793,75 @@ namespace dxvk {
   DxvkMemory DxvkMemoryAllocator::alloc(
     const VkMemoryRequirements& req,
     const VkMemoryPropertyFlags flags) {
-    DxvkMemory result = this->tryAlloc(req, flags);
+    return this->allocMemory(req, nullptr, flags, DxvkMemoryPriority::Normal);
+  }
+  
+  
+  DxvkMemory DxvkMemoryAllocator::alloc(
+    const VkMemoryRequirements&             req,
+    const VkMemoryDedicatedRequirementsKHR& dedAllocReq,
+    const VkMemoryDedicatedAllocateInfoKHR& dedAllocInfo,
+    const VkMemoryPropertyFlags             flags,
+          DxvkMemoryPriority                priority) {
+    const bool useDedicated = m_dedicatedAllocation
+      && (dedAllocReq.prefersDedicatedAllocation
+       || dedAllocReq.requiresDedicatedAllocation);
     
-    if ((result.memory() == VK_NULL_HANDLE) && (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT))
-      result = this->tryAlloc(req, flags & ~VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    return this->allocMemory(req,
+      useDedicated ? &dedAllocInfo : nullptr, flags, priority);
+  }
+  
+  
+  DxvkMemory DxvkMemoryAllocator::allocMemory(
+    const VkMemoryRequirements&             req,
+    const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+    const VkMemoryPropertyFlags             flags,
+          DxvkMemoryPriority                priority) {
+    DxvkMemory result = this->tryAlloc(req, dedAllocInfo, flags, priority, false);
+    
+    // The heap may be over budget, so release unused
+    // chunks and try again if that freed any memory
+    if (result.memory() == VK_NULL_HANDLE && this->trimHeaps(req, flags))
+      result = this->tryAlloc(req, dedAllocInfo, flags, priority, false);
+    
+    // Device-local and cached memory are only performance
+    // hints, so we can use any memory type that is mappable
+    // if the resource needs to be accessed by the host.
+    const VkMemoryPropertyFlags fallbackFlags = flags
+      & ~(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT);
+    
+    if (result.memory() == VK_NULL_HANDLE && fallbackFlags != flags) {
+      result = this->tryAlloc(req, dedAllocInfo, fallbackFlags, priority, false);
+      
+      const bool demoted = result.memory() != VK_NULL_HANDLE
+        && (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+      
+      if (demoted && m_demotionCount++ == 0) {
+        Logger::warn(str::format(
+          "DxvkMemoryAllocator: Device memory over budget, ",
+          "demoting resources to system memory"));
+      }
+    }
+    
+    // Exceeding the budget is still better than failing
+    // the allocation, but may lead to stutter since the
+    // driver will have to evict resources from VRAM.
+    if (result.memory() == VK_NULL_HANDLE) {
+      result = this->tryAlloc(req, dedAllocInfo, flags, priority, true);
+      
+      if (result.memory() == VK_NULL_HANDLE)
+        result = this->tryAlloc(req, dedAllocInfo, fallbackFlags, priority, true);
+      
+      if (result.memory() != VK_NULL_HANDLE && m_oversubscriptionCount++ == 0) {
+        Logger::warn(str::format(
+          "DxvkMemoryAllocator: All memory heaps over budget, ",
+          "performance may suffer"));
+      }
+    }
     
     if (result.memory() == VK_NULL_HANDLE) {
+      this->logStats();
+      
       throw DxvkError(str::format(
         "DxvkMemoryAllocator: Failed to allocate ",
         req.size, " bytes"));
@@ -275,20 +871,193 @@ namespace dxvk {
   }
   
   
+  std::vector<DxvkMemoryStats> DxvkMemoryAllocator::getStats() {
+    std::vector<DxvkMemoryStats> result(m_memProps.memoryTypeCount);
+    
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+      for (const auto& heap : m_heaps[i]) {
+        const DxvkMemoryStats stats = heap->getStats();
+        
+        result[i].memoryAllocated += stats.memoryAllocated;
+        result[i].memoryUsed      += stats.memoryUsed;
+        result[i].chunkCount      += stats.chunkCount;
+        result[i].dedicatedCount  += stats.dedicatedCount;
+        result[i].driverDedicatedCount += stats.driverDedicatedCount;
+        
+        result[i].largestFreeBlock = std::max(
+          result[i].largestFreeBlock, stats.largestFreeBlock);
+      }
+    }
+    
+    return result;
+  }
+  
+  
+  uint32_t DxvkMemoryAllocator::beginDefrag() {
+    uint32_t count = 0;
+    
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+      if (m_memProps.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) {
+        for (const auto& heap : m_heaps[i])
+          count += heap->beginDefrag();
+      }
+    }
+    
+    return count;
+  }
+  
+  
+  void DxvkMemoryAllocator::endDefrag() {
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+      for (const auto& heap : m_heaps[i])
+        heap->endDefrag();
+    }
+  }
+  
+  
+  void DxvkMemoryAllocator::releaseExpiredChunks() {
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount; i++) {
+      for (const auto& heap : m_heaps[i])
+        heap->releaseExpiredChunks();
+    }
+  }
+  
+  
+  DxvkStatCounters DxvkMemoryAllocator::getStatCounters() const {
+    DxvkStatCounters result;
+    result.setCtr(DxvkStatCounter::MemoryDemotionCount, m_demotionCount.load());
+    result.setCtr(DxvkStatCounter::MemoryOverBudget,    m_oversubscriptionCount.load());
+    return result;
+  }
+  
+  
+  void DxvkMemoryAllocator::logStats() {
+    const std::vector<DxvkMemoryStats> stats = this->getStats();
+    
+    for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
+      Logger::info(str::format("DxvkMemoryAllocator: Heap ", i, ": ",
+        m_budgets[i].used.load() >> 10, " kB allocated, ",
+        m_budgets[i].budget      >> 10, " kB budget"));
+    }
+    
+    if (m_demotionCount.load() != 0 || m_oversubscriptionCount.load() != 0) {
+      Logger::info(str::format("DxvkMemoryAllocator: ",
+        m_demotionCount.load(), " allocations demoted, ",
+        m_oversubscriptionCount.load(), " over budget"));
+    }
+    
+    for (uint32_t i = 0; i < stats.size(); i++) {
+      if (stats[i].memoryAllocated == 0)
+        continue;
+      
+      Logger::info(str::format("DxvkMemoryAllocator: Type ", i, ": ",
+        stats[i].memoryUsed      >> 10, " kB used, ",
+        stats[i].memoryAllocated >> 10, " kB allocated, ",
+        stats[i].chunkCount, " chunks, ",
+        stats[i].dedicatedCount, " dedicated (",
+        stats[i].driverDedicatedCount, " requested by driver), ",
+        stats[i].largestFreeBlock >> 10, " kB largest free block, ",
+        uint32_t(100.0 * stats[i].fragmentation()), "% fragmented"));
+    }
+  }
+  
+  
   DxvkMemory DxvkMemoryAllocator::tryAlloc(
-    const VkMemoryRequirements& req,
-    const VkMemoryPropertyFlags flags) {
+    const VkMemoryRequirements&             req,
+    const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+    const VkMemoryPropertyFlags             flags,
+          DxvkMemoryPriority                priority,
+          bool                              ignoreBudget) {
     DxvkMemory result;
     
-    for (uint32_t i = 0; i < m_heaps.size() && result.memory() == VK_NULL_HANDLE; i++) {
+    const uint32_t stripe = getThreadStripe();
+    
+    for (uint32_t i = 0; i < m_memProps.memoryTypeCount && result.memory() == VK_NULL_HANDLE; i++) {
       const bool supported = (req.memoryTypeBits & (1u << i)) != 0;
       const bool adequate  = (m_memProps.memoryTypes[i].propertyFlags & flags) == flags;
       
-      if (supported && adequate)
-        result = m_heaps[i]->alloc(req.size, req.alignment);
+      if (supported && adequate) {
+        const DxvkMemoryBudget& budget = m_budgets[m_memProps.memoryTypes[i].heapIndex];
+        
+        VkDeviceSize memoryLimit = priority == DxvkMemoryPriority::Low
+          ? budget.lowLimit : budget.budget;
+        
+        if (ignoreBudget)
+          memoryLimit = ~VkDeviceSize(0);
+        
+        const auto& heaps = m_heaps[i];
+        const uint32_t first = stripe % heaps.size();
+        
+        // Before the thread's own heap allocates new device memory,
+        // fill free space in chunks that any stripe already owns.
+        // Dedicated allocations never come from chunks anyway.
+        if (heaps.size() > 1 && dedAllocInfo == nullptr) {
+          for (uint32_t j = 0; j < heaps.size() && result.memory() == VK_NULL_HANDLE; j++) {
+            result = heaps[(first + j) % heaps.size()]->allocFromChunks(
+              req.size, req.alignment);
+          }
+        }
+        
+        if (result.memory() == VK_NULL_HANDLE) {
+          result = heaps[first]->alloc(
+            req.size, req.alignment, dedAllocInfo, memoryLimit);
+        }
+      }
     }
     
     return result;
   }
   
+  
+  bool DxvkMemoryAllocator::trimHeaps(
+    const VkMemoryRequirements&             req,
+    const VkMemoryPropertyFlags             flags) {
+    const DxvkMemoryClock::rep now = DxvkMemoryClock::now().time_since_epoch().count();
+    const DxvkMemoryClock::rep interval = m_trimInterval.count();
+    
+    bool trimmed = false;
+    
+    // Only trim the Vulkan heaps that the allocation can come from,
+    // and only once per interval per heap, since allocations will
+    // keep failing for as long as the heap stays over budget.
+    for (uint32_t i = 0; i < m_memProps.memoryHeapCount; i++) {
+      bool used = false;
+      
+      for (uint32_t j = 0; j < m_memProps.memoryTypeCount; j++) {
+        used |= (req.memoryTypeBits & (1u << j))
+             && (m_memProps.memoryTypes[j].propertyFlags & flags) == flags
+             && (m_memProps.memoryTypes[j].heapIndex == i);
+      }
+      
+      if (!used)
+        continue;
+      
+      DxvkMemoryClock::rep lastTrim = m_budgets[i].lastTrim.load();
+      
+      if (now - lastTrim < interval
+       || !m_budgets[i].lastTrim.compare_exchange_strong(lastTrim, now))
+        continue;
+      
+      for (uint32_t j = 0; j < m_memProps.memoryTypeCount; j++) {
+        if (m_memProps.memoryTypes[j].heapIndex == i) {
+          for (const auto& heap : m_heaps[j])
+            heap->trim();
+        }
+      }
+      
+      trimmed = true;
+    }
+    
+    return trimmed;
+  }
+  
+  
+  uint32_t DxvkMemoryAllocator::getThreadStripe() {
+    // Assign stripes to threads in a round-robin fashion
+    // so that they are evenly distributed across threads
+    static std::atomic<uint32_t> s_nextStripe = { 0u };
+    static thread_local uint32_t t_stripe = s_nextStripe++;
+    return t_stripe;
+  }
+  
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <chrono>
+
 #include "dxvk_adapter.h"
+#include "dxvk_extensions.h"
+#include "dxvk_stats.h"
 
 namespace dxvk {
   
@@ -8,6 +12,83 @@ namespace dxvk {
   class DxvkMemoryChunk;
   class DxvkMemoryAllocator;
   
+  using DxvkMemoryClock = std::chrono::high_resolution_clock;
+  
+  /**
+   * \brief Memory allocation priority
+   * 
+   * When a device-local heap runs low on memory, low
+   * priority resources get demoted to system memory
+   * first so that VRAM is kept for resources which
+   * benefit the most from it, such as render targets.
+   */
+  enum class DxvkMemoryPriority : uint32_t {
+    Low     = 0,  ///< Staging and readback buffers
+    Normal  = 1,  ///< All other resources
+  };
+  
+  
+  /**
+   * \brief Memory heap budget
+   * 
+   * Tracks the amount of device memory allocated from
+   * a single Vulkan memory heap. The allocator tries to
+   * stay within the budget so that the driver does not
+   * have to evict resources from VRAM, and low priority
+   * resources have to stay within a lower limit.
+   */
+  struct DxvkMemoryBudget {
+    /// Memory limit for normal priority resources
+    VkDeviceSize              budget   = 0;
+    /// Memory limit for low priority resources
+    VkDeviceSize              lowLimit = 0;
+    /// Amount of device memory currently allocated
+    std::atomic<VkDeviceSize> used     = { 0ull };
+    /// Time when unused chunks were last released
+    /// because an allocation exceeded the budget
+    std::atomic<DxvkMemoryClock::rep> lastTrim = { 0 };
+  };
+  
+  /**
+   * \brief Memory statistics
+   * 
+   * Allocation statistics for a single memory
+   * type. All sizes are given in bytes.
+   */
+  struct DxvkMemoryStats {
+    /// Device memory allocated from the driver,
+    /// including dedicated allocations
+    VkDeviceSize memoryAllocated  = 0;
+    /// Memory actually used by resources
+    VkDeviceSize memoryUsed       = 0;
+    /// Largest free block in any chunk
+    VkDeviceSize largestFreeBlock = 0;
+    /// Number of chunks
+    uint32_t     chunkCount       = 0;
+    /// Number of dedicated allocations
+    uint32_t     dedicatedCount   = 0;
+    /// Number of dedicated allocations that
+    /// were preferred or required by the driver
+    uint32_t     driverDedicatedCount = 0;
+    
+    /**
+     * \brief Fragmentation ratio
+     * 
+     * Fraction of unused chunk memory that is not
+     * part of the largest free block. Zero if all
+     * free memory is contiguous, close to one if
+     * free memory is scattered across many blocks.
+     * \returns Fragmentation ratio
+     */
+    double fragmentation() const {
+      const VkDeviceSize memoryFree = memoryAllocated - memoryUsed;
+      
+      return memoryFree != 0
+        ? 1.0 - double(largestFreeBlock) / double(memoryFree)
+        : 0.0;
+    }
+  };
+  
   
   /**
    * \brief Memory slice
@@ -26,7 +107,9 @@ namespace dxvk {
       VkDeviceMemory    memory,
       VkDeviceSize      offset,
       VkDeviceSize      length,
-      void*             mapPtr);
+      void*             mapPtr,
+      uint32_t          block = 0,
+      bool              driverDedicated = false);
     DxvkMemory             (DxvkMemory&& other);
     DxvkMemory& operator = (DxvkMemory&& other);
     ~DxvkMemory();
@@ -63,6 +146,16 @@ namespace dxvk {
       return reinterpret_cast<char*>(m_mapPtr) + offset;
     }
     
+    /**
+     * \brief Checks whether the memory should be moved
+     * 
+     * If the chunk this slice was allocated from is being
+     * evacuated by the defragmenter, the resource that owns
+     * this slice should be moved to a different location.
+     * \returns \c true if the slice's chunk is being evacuated
+     */
+    bool isEvacuating() const;
+    
   private:
     
     DxvkMemoryChunk*  m_chunk  = nullptr;
@@ -71,6 +164,10 @@ namespace dxvk {
     VkDeviceSize      m_offset = 0;
     VkDeviceSize      m_length = 0;
     void*             m_mapPtr = nullptr;
+    uint32_t          m_block  = 0;
+    bool              m_driverDedicated = false;
+    
+    void free();
     
   };
   
@@ -80,6 +177,14 @@ namespace dxvk {
    * 
    * A single chunk of memory that provides a
    * sub-allocator. This is not thread-safe.
+   * 
+   * Free ranges are managed with a two-level
+   * segregated fit (TLSF) scheme: free blocks are
+   * binned by size into lists indexed by the most
+   * significant bits of their size, and a pair of
+   * bit masks tracks which lists are non-empty.
+   * Both allocation and freeing run in constant
+   * time regardless of the number of free blocks.
    */
   class DxvkMemoryChunk : public RcObject {
     
@@ -112,18 +217,100 @@ namespace dxvk {
      * Returns a slice back to the chunk.
      * Called automatically when a memory
      * slice runs out of scope.
-     * \param [in] offset Slice offset
-     * \param [in] length Slice length
+     * \param [in] block Block index of the slice
      */
     void free(
-            VkDeviceSize  offset,
-            VkDeviceSize  length);
+            uint32_t      block);
+    
+    /**
+     * \brief Chunk size
+     * \returns Size of the chunk, in bytes
+     */
+    VkDeviceSize size() const {
+      return m_size;
+    }
+    
+    /**
+     * \brief Amount of memory in use
+     * \returns Number of bytes allocated from the chunk
+     */
+    VkDeviceSize used() const {
+      return m_used;
+    }
+    
+    /**
+     * \brief Checks whether the chunk is empty
+     * \returns \c true if no memory is allocated
+     */
+    bool isEmpty() const {
+      return m_delta == 0;
+    }
+    
+    /**
+     * \brief Checks whether the chunk is being evacuated
+     * 
+     * New allocations are not placed in chunks which
+     * the defragmenter is trying to empty. May be read
+     * without holding the heap lock.
+     * \returns \c true if the chunk is being evacuated
+     */
+    bool isEvacuating() const {
+      return m_evacuating.load();
+    }
+    
+    /**
+     * \brief Marks or unmarks the chunk for evacuation
+     * \param [in] evacuating Whether to evacuate the chunk
+     */
+    void setEvacuating(bool evacuating) {
+      m_evacuating.store(evacuating);
+    }
+    
+    /**
+     * \brief Time at which the chunk became empty
+     * 
+     * Only meaningful if the chunk is empty.
+     * \returns Time of the last free operation
+     */
+    DxvkMemoryClock::time_point emptySince() const {
+      return m_emptySince;
+    }
+    
+    /**
+     * \brief Adds chunk statistics
+     * \param [in,out] stats Memory statistics
+     */
+    void getStats(DxvkMemoryStats& stats) const;
     
   private:
     
-    struct FreeSlice {
+    /// Number of bits used for the second-level index
+    static constexpr uint32_t SlBits  = 4;
+    static constexpr uint32_t SlCount = 1u << SlBits;
+    
+    /// Number of first-level size classes
+    static constexpr uint32_t FlCount = 64 - SlBits + 1;
+    
+    /// Invalid block index
+    static constexpr uint32_t NullBlock = ~0u;
+    
+    /**
+     * \brief Memory block
+     * 
+     * A contiguous range of the chunk, which is either
+     * free or allocated. Blocks are linked with their
+     * physical neighbours so that adjacent free blocks
+     * can be merged, and free blocks are additionally
+     * linked into the free list of their size class.
+     */
+    struct Block {
       VkDeviceSize offset;
       VkDeviceSize length;
+      uint32_t     prevPhys;
+      uint32_t     nextPhys;
+      uint32_t     prevFree;
+      uint32_t     nextFree;
+      bool         isFree;
     };
     
     DxvkMemoryHeap* const m_heap;
@@ -131,7 +318,39 @@ namespace dxvk {
     void*           const m_mapPtr;
     VkDeviceSize    const m_size;
     size_t m_delta = 0;
-    std::vector<FreeSlice> m_freeList;
+    VkDeviceSize m_used = 0;
+    
+    std::atomic<bool> m_evacuating = { false };
+    
+    DxvkMemoryClock::time_point m_emptySince;
+    
+    std::vector<Block>    m_blocks;
+    std::vector<uint32_t> m_unusedBlocks;
+    
+    uint64_t                                    m_flBitmap = 0;
+    std::array<uint32_t, FlCount>               m_slBitmaps;
+    std::array<uint32_t, FlCount * SlCount>     m_freeLists;
+    
+    uint32_t createBlock(
+            VkDeviceSize  offset,
+            VkDeviceSize  length);
+    
+    void destroyBlock(
+            uint32_t      index);
+    
+    void insertFreeBlock(
+            uint32_t      index);
+    
+    void removeFreeBlock(
+            uint32_t      index);
+    
+    uint32_t findFreeBlock(
+            VkDeviceSize  length) const;
+    
+    static void mapSize(
+            VkDeviceSize  length,
+            uint32_t&     fl,
+            uint32_t&     sl);
     
   };
   
@@ -141,6 +360,18 @@ namespace dxvk {
    * 
    * Implements a memory allocator for a single
    * memory type. This class is thread-safe.
+   * 
+   * Chunks that have been empty for longer than the
+   * grace period are returned to the driver. Heaps may
+   * keep one spare chunk around so that alternating
+   * allocations and frees do not cause device memory
+   * to be allocated over and over.
+   * 
+   * The size of new chunks grows with the amount of
+   * memory allocated from the heap, up to a limit that
+   * depends on the size of the Vulkan memory heap.
+   * Allocations of at least a quarter of the current
+   * chunk size get a dedicated device allocation.
    */
   class DxvkMemoryHeap : public RcObject {
     friend class DxvkMemory;
@@ -150,7 +381,11 @@ namespace dxvk {
     DxvkMemoryHeap(
       const Rc<vk::DeviceFn>    vkd,
             uint32_t            memTypeId,
-            VkMemoryType        memType);
+            VkMemoryType        memType,
+            VkMemoryHeap        memHeap,
+            DxvkMemoryBudget*   budget,
+            std::chrono::milliseconds gracePeriod,
+            bool                keepSpare);
     
     DxvkMemoryHeap             (DxvkMemoryHeap&&) = delete;
     DxvkMemoryHeap& operator = (DxvkMemoryHeap&&) = delete;
@@ -164,37 +399,139 @@ namespace dxvk {
      * enough to justify a dedicated device allocation,
      * this will try to sub-allocate the block from an
      * existing chunk and create new chunks as necessary.
+     * Fails if new device memory would have to be
+     * allocated and the heap budget would be exceeded.
      * \param [in] size Amount of memory to allocate
      * \param [in] align Alignment requirements
+     * \param [in] dedAllocInfo Dedicated allocation info,
+     *        if the driver prefers a dedicated allocation
+     * \param [in] memoryLimit Maximum amount of memory
+     *        that may be allocated from the Vulkan heap
      * \returns The allocated memory slice
      */
     DxvkMemory alloc(
-            VkDeviceSize size,
-            VkDeviceSize align);
+            VkDeviceSize                      size,
+            VkDeviceSize                      align,
+      const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+            VkDeviceSize                      memoryLimit);
+    
+    /**
+     * \brief Allocates memory from existing chunks
+     * 
+     * Never allocates new device memory. Used to fill
+     * free space in chunks owned by other stripes of
+     * the same memory type before growing a heap.
+     * \param [in] size Amount of memory to allocate
+     * \param [in] align Alignment requirements
+     * \returns The allocated memory slice
+     */
+    DxvkMemory allocFromChunks(
+            VkDeviceSize                      size,
+            VkDeviceSize                      align);
+    
+    /**
+     * \brief Frees all empty chunks
+     * 
+     * Returns all unused device memory to the driver,
+     * including the spare chunk. Used when the device
+     * runs out of memory.
+     */
+    void trim();
+    
+    /**
+     * \brief Frees expired empty chunks
+     * 
+     * Returns chunks that have been empty for longer
+     * than the grace period to the driver. Called
+     * periodically so that heaps which no longer see
+     * any frees release their memory as well.
+     */
+    void releaseExpiredChunks();
+    
+    /**
+     * \brief Retrieves memory statistics
+     * \returns Statistics for this memory type
+     */
+    DxvkMemoryStats getStats();
+    
+    /**
+     * \brief Selects chunks to defragment
+     * 
+     * Marks sparsely used chunks for evacuation, starting
+     * with the emptiest one, as long as the remaining
+     * chunks have enough free space to hold their data.
+     * \returns Number of chunks marked for evacuation
+     */
+    uint32_t beginDefrag();
+    
+    /**
+     * \brief Unmarks all chunks marked for evacuation
+     */
+    void endDefrag();
     
   private:
     
+    /// Chunks below this fraction of use get evacuated
+    static constexpr VkDeviceSize DefragThreshold   = 4;
+    
+    static constexpr VkDeviceSize MinChunkSize      =  16 << 20;
+    static constexpr VkDeviceSize MaxChunkSize      = 256 << 20;
+    static constexpr VkDeviceSize MinChunkSizeLimit =   1 << 20;
+    
     const Rc<vk::DeviceFn>           m_vkd;
     const uint32_t                   m_memTypeId;
     const VkMemoryType               m_memType;
-    const VkDeviceSize               m_chunkSize = 16 * 1024 * 1024;
+    const VkMemoryHeap               m_memHeap;
+    DxvkMemoryBudget* const          m_budget;
+    const std::chrono::milliseconds  m_gracePeriod;
+    const bool                       m_keepSpare;
+    
+    VkDeviceSize                     m_minChunkSize;
+    VkDeviceSize                     m_maxChunkSize;
     
     std::mutex                       m_mutex;
     std::vector<Rc<DxvkMemoryChunk>> m_chunks;
+    VkDeviceSize                     m_chunkSize   = 0;
+    VkDeviceSize                     m_chunkMemory = 0;
+    size_t                           m_emptyChunks = 0;
+    DxvkMemoryClock::time_point      m_lastRelease;
+    
+    std::atomic<uint32_t>            m_dedicatedCount = { 0u };
+    std::atomic<VkDeviceSize>        m_dedicatedSize  = { 0ull };
+    std::atomic<uint32_t>            m_driverDedicatedCount = { 0u };
+    
+    void releaseEmptyChunks(
+            DxvkMemoryClock::time_point now,
+            bool            releaseSpare);
+    
+    void checkEmptyChunks();
+    
+    DxvkMemory allocChunkMemory(
+            VkDeviceSize    size,
+            VkDeviceSize    align);
+    
+    void updateChunkSize();
     
     VkDeviceMemory allocDeviceMemory(
-            VkDeviceSize    memorySize);
+            VkDeviceSize                      memorySize,
+      const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+            VkDeviceSize                      memoryLimit);
     
     void freeDeviceMemory(
-            VkDeviceMemory  memory);
+            VkDeviceMemory  memory,
+            VkDeviceSize    memorySize);
+    
+    void freeDedicatedMemory(
+            VkDeviceMemory  memory,
+            VkDeviceSize    length,
+            bool            driverDedicated);
     
     void* mapDeviceMemory(
             VkDeviceMemory  memory);
     
     void free(
             DxvkMemoryChunk*  chunk,
-            VkDeviceSize      offset,
-            VkDeviceSize      length);
+            uint32_t          block);
     
   };
   
@@ -204,14 +541,27 @@ namespace dxvk {
    * 
    * Allocates device memory for Vulkan resources.
    * Memory objects will be destroyed automatically.
+   * 
+   * Each memory type is backed by one or more heaps.
+   * Threads are assigned to one heap per memory type,
+   * which reduces lock contention when resources are
+   * created from multiple threads at the same time.
+   * Free space in other heaps of the same memory type
+   * is used before any new device memory is allocated,
+   * and only the first heap keeps a spare chunk.
+   * 
+   * If a device-local heap runs out of budget, resources
+   * are demoted to system memory. The budget is only
+   * exceeded if no other memory type can be used.
    */
   class DxvkMemoryAllocator : public RcObject {
     friend class DxvkMemory;
   public:
     
     DxvkMemoryAllocator(
-      const Rc<DxvkAdapter>&  adapter,
-      const Rc<vk::DeviceFn>& vkd);
+      const Rc<DxvkAdapter>&      adapter,
+      const Rc<vk::DeviceFn>&     vkd,
+      const DxvkDeviceExtensions& extensions);
     ~DxvkMemoryAllocator();
     
     /**
@@ -225,16 +575,125 @@ namespace dxvk {
       const VkMemoryRequirements& req,
       const VkMemoryPropertyFlags flags);
     
+    /**
+     * \brief Allocates device memory for a resource
+     * 
+     * Uses a dedicated device allocation if the driver
+     * prefers or requires one for the given resource.
+     * \param [in] req Memory requirements
+     * \param [in] dedAllocReq Dedicated allocation requirements
+     * \param [in] dedAllocInfo Dedicated allocation info
+     * \param [in] flags Memory type flags
+     * \param [in] priority Allocation priority
+     * \returns Allocated memory slice
+     */
+    DxvkMemory alloc(
+      const VkMemoryRequirements&             req,
+      const VkMemoryDedicatedRequirementsKHR& dedAllocReq,
+      const VkMemoryDedicatedAllocateInfoKHR& dedAllocInfo,
+      const VkMemoryPropertyFlags             flags,
+            DxvkMemoryPriority                priority);
+    
+    /**
+     * \brief Checks for dedicated allocation support
+     * 
+     * If supported, memory requirements must be queried
+     * with \c vkGet*MemoryRequirements2KHR so that the
+     * dedicated allocation requirements are known.
+     * \returns \c true if dedicated allocations are supported
+     */
+    bool supportsDedicatedAllocation() const {
+      return m_dedicatedAllocation;
+    }
+    
+    /**
+     * \brief Retrieves memory statistics
+     * 
+     * Locks each heap in turn, so this should
+     * not be called at a high frequency.
+     * \returns Statistics for each memory type
+     */
+    std::vector<DxvkMemoryStats> getStats();
+    
+    /**
+     * \brief Selects chunks to defragment
+     * 
+     * Marks sparsely used chunks of device-local memory
+     * types for evacuation. Memory is not allocated from
+     * these chunks until \ref endDefrag is called.
+     * \returns Number of chunks marked for evacuation
+     */
+    uint32_t beginDefrag();
+    
+    /**
+     * \brief Ends defragmentation
+     * 
+     * Chunks which have not been fully evacuated
+     * can be used for allocations again.
+     */
+    void endDefrag();
+    
+    /**
+     * \brief Frees expired empty chunks
+     * 
+     * Should be called once per frame so that empty
+     * chunks get released after the grace period even
+     * if no memory gets allocated or freed.
+     */
+    void releaseExpiredChunks();
+    
+    /**
+     * \brief Retrieves oversubscription counters
+     * 
+     * Counts allocations that had to be demoted to
+     * system memory and allocations that exceeded
+     * the budget of their memory heap.
+     * \returns Stat counters
+     */
+    DxvkStatCounters getStatCounters() const;
+    
+    /**
+     * \brief Writes memory statistics to the log
+     */
+    void logStats();
+    
   private:
     
+    /// Maximum number of heaps per memory type
+    static constexpr VkDeviceSize MaxNumStripes  = 8;
+    /// Vulkan heap size required for each stripe
+    static constexpr VkDeviceSize StripeHeapSize = 1ull << 30;
+    
     const Rc<vk::DeviceFn>                 m_vkd;
     const VkPhysicalDeviceMemoryProperties m_memProps;
+    const bool                             m_dedicatedAllocation;
+    
+    std::array<DxvkMemoryBudget, VK_MAX_MEMORY_HEAPS> m_budgets;
+    std::array<std::vector<Rc<DxvkMemoryHeap>>, VK_MAX_MEMORY_TYPES> m_heaps;
+    
+    DxvkMemoryClock::duration m_trimInterval;
     
-    std::array<Rc<DxvkMemoryHeap>, VK_MAX_MEMORY_TYPES> m_heaps;
+    std::atomic<uint64_t> m_demotionCount         = { 0ull };
+    std::atomic<uint64_t> m_oversubscriptionCount = { 0ull };
+    
+    DxvkMemory allocMemory(
+      const VkMemoryRequirements&             req,
+      const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+      const VkMemoryPropertyFlags             flags,
+            DxvkMemoryPriority                priority);
     
     DxvkMemory tryAlloc(
-      const VkMemoryRequirements& req,
-      const VkMemoryPropertyFlags flags);
+      const VkMemoryRequirements&             req,
+      const VkMemoryDedicatedAllocateInfoKHR* dedAllocInfo,
+      const VkMemoryPropertyFlags             flags,
+            DxvkMemoryPriority                priority,
+            bool                              ignoreBudget);
+    
+    bool trimHeaps(
+      const VkMemoryRequirements&             req,
+      const VkMemoryPropertyFlags             flags);
+    
+    static uint32_t getThreadStripe();
     
   };
   
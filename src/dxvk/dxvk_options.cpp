@@ -14,17 +14,33 @@ namespace dxvk {
     
     if (appOptions != g_appOptions.end())
       m_options.set(appOptions->second);
+    
+    if (env::getEnvVar(L"DXVK_PARALLEL_CMDLISTS") == "1")
+      m_options.set(DxvkOption::ParallelCommandLists);
+    
+    if (env::getEnvVar(L"DXVK_DEFRAGMENT_MEMORY") == "1")
+      m_options.set(DxvkOption::DefragmentMemory);
+    
+    if (env::getEnvVar(L"DXVK_ASYNC_TRANSFER") == "1")
+      m_options.set(DxvkOption::AsyncTransfer);
   }
   
   
   void DxvkOptions::adjustDeviceOptions(const Rc<DxvkAdapter>& adapter) {
-    
+    if (m_options.test(DxvkOption::AsyncTransfer)
+     && adapter->transferQueueFamily() == adapter->graphicsQueueFamily()) {
+      Logger::warn("DxvkOptions: No dedicated transfer queue, disabling async transfers");
+      m_options.clr(DxvkOption::AsyncTransfer);
+    }
   }
   
   
   void DxvkOptions::logOptions() const {
     #define LOG_OPTION(opt) this->logOption(DxvkOption::opt, #opt)
     LOG_OPTION(AssumeNoZfight);
+    LOG_OPTION(ParallelCommandLists);
+    LOG_OPTION(DefragmentMemory);
+    LOG_OPTION(AsyncTransfer);
     #undef LOG_OPTION
   }
   
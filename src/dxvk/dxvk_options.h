@@ -13,6 +13,22 @@ namespace dxvk {
     /// value. Allows out-of-order rasterization to
     /// be enabled for more rendering modes.
     AssumeNoZfight = 0,
+    
+    /// Record command lists from deferred contexts into
+    /// Vulkan command buffers on worker threads when
+    /// they are executed. Consecutively executed command
+    /// lists are recorded in parallel.
+    ParallelCommandLists = 1,
+    
+    /// Move buffers out of sparsely used device
+    /// memory chunks so that the chunks can be
+    /// freed. Costs some GPU time for the copies.
+    DefragmentMemory = 2,
+    
+    /// Upload initial resource data on a dedicated
+    /// transfer queue so that streaming does not
+    /// compete with rendering on the graphics queue.
+    AsyncTransfer = 3,
   };
   
   using DxvkOptionSet = Flags<DxvkOption>;
@@ -0,0 +1,314 @@
+#include <cstring>
+
+#include "dxvk_pack.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define DXVK_PACK_X86
+#endif
+
+#ifdef DXVK_PACK_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DXVK_PACK_TARGET(isa)
+#else
+#define DXVK_PACK_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace dxvk::util {
+  
+  using CopyRowsFn = void (*)(char*, const char*, size_t, size_t, size_t, size_t);
+  
+  /// Row size from which on the C library's memcpy is
+  /// at least as fast as our kernels, which mostly win
+  /// by avoiding call overhead for short rows.
+  constexpr size_t MaxVectorRowSize = 1024;
+  
+  /**
+   * \brief Copies less than 16 bytes
+   * 
+   * Uses two potentially overlapping fixed-size
+   * moves instead of a variable-length memcpy
+   * call, which matters for tiny mip levels.
+   */
+  inline void copySmall(char* dst, const char* src, size_t size) {
+    if (size >= 8) {
+      uint64_t a, b;
+      std::memcpy(&a, src, 8);
+      std::memcpy(&b, src + size - 8, 8);
+      std::memcpy(dst, &a, 8);
+      std::memcpy(dst + size - 8, &b, 8);
+    } else if (size >= 4) {
+      uint32_t a, b;
+      std::memcpy(&a, src, 4);
+      std::memcpy(&b, src + size - 4, 4);
+      std::memcpy(dst, &a, 4);
+      std::memcpy(dst + size - 4, &b, 4);
+    } else {
+      for (size_t i = 0; i < size; i++)
+        dst[i] = src[i];
+    }
+  }
+  
+  
+  void copyRowsScalar(
+          char*             dstData,
+    const char*             srcData,
+          size_t            rowSize,
+          size_t            rowCount,
+          size_t            dstPitch,
+          size_t            srcPitch) {
+    for (size_t i = 0; i < rowCount; i++) {
+      std::memcpy(dstData, srcData, rowSize);
+      dstData += dstPitch;
+      srcData += srcPitch;
+    }
+  }
+  
+  
+#ifdef DXVK_PACK_X86
+  DXVK_PACK_TARGET("sse2")
+  void copyRowsSse2(
+          char*             dstData,
+    const char*             srcData,
+          size_t            rowSize,
+          size_t            rowCount,
+          size_t            dstPitch,
+          size_t            srcPitch) {
+    if (rowSize < 16) {
+      for (size_t i = 0; i < rowCount; i++) {
+        copySmall(dstData, srcData, rowSize);
+        dstData += dstPitch;
+        srcData += srcPitch;
+      }
+      return;
+    }
+    
+    for (size_t i = 0; i < rowCount; i++) {
+      auto src = reinterpret_cast<const __m128i*>(srcData);
+      auto dst = reinterpret_cast<      __m128i*>(dstData);
+      
+      size_t offset = 0;
+      
+      for ( ; offset + 64 <= rowSize; offset += 64) {
+        __m128i a = _mm_loadu_si128(src + 0);
+        __m128i b = _mm_loadu_si128(src + 1);
+        __m128i c = _mm_loadu_si128(src + 2);
+        __m128i d = _mm_loadu_si128(src + 3);
+        _mm_storeu_si128(dst + 0, a);
+        _mm_storeu_si128(dst + 1, b);
+        _mm_storeu_si128(dst + 2, c);
+        _mm_storeu_si128(dst + 3, d);
+        src += 4;
+        dst += 4;
+      }
+      
+      for ( ; offset + 16 <= rowSize; offset += 16)
+        _mm_storeu_si128(dst++, _mm_loadu_si128(src++));
+      
+      // Copy the remainder with an overlapping move
+      // rather than falling back to byte-wise copies
+      if (offset < rowSize) {
+        _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(dstData + rowSize - 16),
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcData + rowSize - 16)));
+      }
+      
+      dstData += dstPitch;
+      srcData += srcPitch;
+    }
+  }
+  
+  
+  DXVK_PACK_TARGET("avx2")
+  void copyRowsAvx2(
+          char*             dstData,
+    const char*             srcData,
+          size_t            rowSize,
+          size_t            rowCount,
+          size_t            dstPitch,
+          size_t            srcPitch) {
+    if (rowSize < 32) {
+      for (size_t i = 0; i < rowCount; i++) {
+        if (rowSize >= 16) {
+          __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcData));
+          __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(srcData + rowSize - 16));
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(dstData), a);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(dstData + rowSize - 16), b);
+        } else {
+          copySmall(dstData, srcData, rowSize);
+        }
+        
+        dstData += dstPitch;
+        srcData += srcPitch;
+      }
+      return;
+    }
+    
+    for (size_t i = 0; i < rowCount; i++) {
+      auto src = reinterpret_cast<const __m256i*>(srcData);
+      auto dst = reinterpret_cast<      __m256i*>(dstData);
+      
+      size_t offset = 0;
+      
+      for ( ; offset + 128 <= rowSize; offset += 128) {
+        __m256i a = _mm256_loadu_si256(src + 0);
+        __m256i b = _mm256_loadu_si256(src + 1);
+        __m256i c = _mm256_loadu_si256(src + 2);
+        __m256i d = _mm256_loadu_si256(src + 3);
+        _mm256_storeu_si256(dst + 0, a);
+        _mm256_storeu_si256(dst + 1, b);
+        _mm256_storeu_si256(dst + 2, c);
+        _mm256_storeu_si256(dst + 3, d);
+        src += 4;
+        dst += 4;
+      }
+      
+      for ( ; offset + 32 <= rowSize; offset += 32)
+        _mm256_storeu_si256(dst++, _mm256_loadu_si256(src++));
+      
+      if (offset < rowSize) {
+        _mm256_storeu_si256(
+          reinterpret_cast<__m256i*>(dstData + rowSize - 32),
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcData + rowSize - 32)));
+      }
+      
+      dstData += dstPitch;
+      srcData += srcPitch;
+    }
+    
+    _mm256_zeroupper();
+  }
+#endif
+  
+  
+  bool isPackIsaSupported(PackIsa isa) {
+    switch (isa) {
+      case PackIsa::Scalar:
+        return true;
+      
+#ifdef DXVK_PACK_X86
+#ifdef _MSC_VER
+      case PackIsa::Sse2: {
+        int regs[4];
+        __cpuid(regs, 1);
+        return (regs[3] & (1 << 26)) != 0;
+      }
+      
+      case PackIsa::Avx2: {
+        int regs[4];
+        __cpuid(regs, 0);
+        
+        if (regs[0] < 7)
+          return false;
+        
+        // AVX requires OS support for saving the YMM registers
+        __cpuid(regs, 1);
+        
+        if (!(regs[2] & (1 << 27)) || !(regs[2] & (1 << 28)))
+          return false;
+        
+        if ((_xgetbv(0) & 0x6) != 0x6)
+          return false;
+        
+        __cpuidex(regs, 7, 0);
+        return (regs[1] & (1 << 5)) != 0;
+      }
+#else
+      case PackIsa::Sse2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse2");
+      
+      case PackIsa::Avx2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+#endif
+      
+      default:
+        return false;
+    }
+  }
+  
+  
+  PackIsa getPackIsa() {
+    static const PackIsa s_isa = [] {
+      if (isPackIsaSupported(PackIsa::Avx2))
+        return PackIsa::Avx2;
+      if (isPackIsaSupported(PackIsa::Sse2))
+        return PackIsa::Sse2;
+      return PackIsa::Scalar;
+    } ();
+    
+    return s_isa;
+  }
+  
+  
+  void copyImageRows(
+          PackIsa           isa,
+          char*             dstData,
+    const char*             srcData,
+          size_t            rowSize,
+          size_t            rowCount,
+          size_t            dstPitch,
+          size_t            srcPitch) {
+    CopyRowsFn fn = &copyRowsScalar;
+    
+#ifdef DXVK_PACK_X86
+    switch (isa) {
+      case PackIsa::Scalar: fn = &copyRowsScalar; break;
+      case PackIsa::Sse2:   fn = &copyRowsSse2;   break;
+      case PackIsa::Avx2:   fn = &copyRowsAvx2;   break;
+    }
+#endif
+    
+    fn(dstData, srcData, rowSize, rowCount, dstPitch, srcPitch);
+  }
+  
+  
+  void copyImageData(
+          char*             dstData,
+    const char*             srcData,
+          VkExtent3D        blockCount,
+          VkDeviceSize      blockSize,
+          VkDeviceSize      dstPitchPerRow,
+          VkDeviceSize      dstPitchPerLayer,
+          VkDeviceSize      srcPitchPerRow,
+          VkDeviceSize      srcPitchPerLayer) {
+    const VkDeviceSize bytesPerRow   = blockCount.width  * blockSize;
+    const VkDeviceSize bytesPerLayer = blockCount.height * bytesPerRow;
+    const VkDeviceSize bytesTotal    = blockCount.depth  * bytesPerLayer;
+    
+    const bool rowsPacked = (blockCount.height == 1)
+      || (bytesPerRow == srcPitchPerRow && bytesPerRow == dstPitchPerRow);
+    
+    const bool layersPacked = (blockCount.depth == 1)
+      || (bytesPerLayer == srcPitchPerLayer && bytesPerLayer == dstPitchPerLayer);
+    
+    // The C library's memcpy is hard to beat for large
+    // contiguous copies, so only use our own kernels
+    // if the data actually needs to be repacked.
+    if (rowsPacked && layersPacked) {
+      std::memcpy(dstData, srcData, bytesTotal);
+      return;
+    }
+    
+    const PackIsa isa = bytesPerRow < MaxVectorRowSize
+      ? getPackIsa() : PackIsa::Scalar;
+    
+    for (uint32_t i = 0; i < blockCount.depth; i++) {
+      if (rowsPacked) {
+        std::memcpy(dstData, srcData, bytesPerLayer);
+      } else {
+        copyImageRows(isa, dstData, srcData,
+          bytesPerRow, blockCount.height,
+          dstPitchPerRow, srcPitchPerRow);
+      }
+      
+      dstData += dstPitchPerLayer;
+      srcData += srcPitchPerLayer;
+    }
+  }
+  
+}
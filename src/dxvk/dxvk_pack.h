@@ -0,0 +1,88 @@
+#pragma once
+
+#include "dxvk_include.h"
+
+namespace dxvk::util {
+  
+  /**
+   * \brief Instruction set for image copies
+   * 
+   * Determines which kernel is used to copy rows of
+   * pixels or blocks between buffers with different
+   * row pitches. Kernels with a higher value are
+   * preferred if supported by the host CPU.
+   */
+  enum class PackIsa : uint32_t {
+    Scalar  = 0,
+    Sse2    = 1,
+    Avx2    = 2,
+  };
+  
+  /**
+   * \brief Checks whether an instruction set is supported
+   * 
+   * \param [in] isa The instruction set
+   * \returns \c true if the host CPU and operating
+   *          system support the given instruction set
+   */
+  bool isPackIsaSupported(PackIsa isa);
+  
+  /**
+   * \brief Best supported instruction set
+   * 
+   * Queried once and cached. This is what
+   * \ref copyImageData uses internally.
+   * \returns Preferred instruction set
+   */
+  PackIsa getPackIsa();
+  
+  /**
+   * \brief Copies rows of image data
+   * 
+   * Copies \c rowCount rows of \c rowSize bytes each.
+   * The source and destination must not overlap, and
+   * the given instruction set must be supported.
+   * \param [in] isa Instruction set to use
+   * \param [in] dstData Destination pointer
+   * \param [in] srcData Source pointer
+   * \param [in] rowSize Number of bytes per row
+   * \param [in] rowCount Number of rows to copy
+   * \param [in] dstPitch Destination bytes between rows
+   * \param [in] srcPitch Source bytes between rows
+   */
+  void copyImageRows(
+          PackIsa           isa,
+          char*             dstData,
+    const char*             srcData,
+          size_t            rowSize,
+          size_t            rowCount,
+          size_t            dstPitch,
+          size_t            srcPitch);
+  
+  /**
+   * \brief Copies image data between pitched buffers
+   * 
+   * Works for both compressed and uncompressed formats,
+   * since the extent and pitches are given in blocks.
+   * Contiguous regions are copied in one go, and long
+   * rows are always copied with \c memcpy.
+   * \param [in] dstData Destination buffer pointer
+   * \param [in] srcData Pointer to source data
+   * \param [in] blockCount Number of blocks to copy
+   * \param [in] blockSize Number of bytes per block
+   * \param [in] dstPitchPerRow Destination bytes between rows
+   * \param [in] dstPitchPerLayer Destination bytes between layers
+   * \param [in] srcPitchPerRow Source bytes between rows
+   * \param [in] srcPitchPerLayer Source bytes between layers
+   */
+  void copyImageData(
+          char*             dstData,
+    const char*             srcData,
+          VkExtent3D        blockCount,
+          VkDeviceSize      blockSize,
+          VkDeviceSize      dstPitchPerRow,
+          VkDeviceSize      dstPitchPerLayer,
+          VkDeviceSize      srcPitchPerRow,
+          VkDeviceSize      srcPitchPerLayer);
+  
+}
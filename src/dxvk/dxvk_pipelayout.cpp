@@ -1,5 +1,6 @@
 #include <cstring>
 
+#include "dxvk_descriptor.h"
 #include "dxvk_pipelayout.h"
 
 namespace dxvk {
@@ -41,16 +42,32 @@ namespace dxvk {
   }
   
   
+  void DxvkDescriptorSlotMapping::makeDescriptorsDynamic(
+          uint32_t              uniformBuffers) {
+    for (auto& slotInfo : m_descriptorSlots) {
+      if (slotInfo.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER && uniformBuffers != 0) {
+        slotInfo.type   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        uniformBuffers -= 1;
+      }
+    }
+  }
+  
+  
   DxvkPipelineLayout::DxvkPipelineLayout(
     const Rc<vk::DeviceFn>&   vkd,
           uint32_t            bindingCount,
-    const DxvkDescriptorSlot* bindingInfos)
+    const DxvkDescriptorSlot* bindingInfos,
+          bool                useTemplate)
   : m_vkd(vkd) {
     
     m_bindingSlots.resize(bindingCount);
     
-    for (uint32_t i = 0; i < bindingCount; i++)
+    for (uint32_t i = 0; i < bindingCount; i++) {
       m_bindingSlots[i] = bindingInfos[i];
+      
+      if (bindingInfos[i].type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC)
+        m_dynamicSlots.push_back(i);
+    }
     
     std::vector<VkDescriptorSetLayoutBinding> bindings;
     
@@ -90,10 +107,53 @@ namespace dxvk {
         m_vkd->device(), m_descriptorSetLayout, nullptr);
       throw DxvkError("DxvkPipelineLayout: Failed to create pipeline layout");
     }
+    
+    // Templates must have at least one entry. The template
+    // reads one descriptor info per binding, which works
+    // since the info is a union of all relevant structs.
+    if (useTemplate && bindingCount != 0) {
+      std::vector<VkDescriptorUpdateTemplateEntryKHR> entries;
+      
+      for (uint32_t i = 0; i < bindingCount; i++) {
+        VkDescriptorUpdateTemplateEntryKHR entry;
+        entry.dstBinding      = i;
+        entry.dstArrayElement = 0;
+        entry.descriptorCount = 1;
+        entry.descriptorType  = bindingInfos[i].type;
+        entry.offset          = sizeof(DxvkDescriptorInfo) * i;
+        entry.stride          = sizeof(DxvkDescriptorInfo);
+        entries.push_back(entry);
+      }
+      
+      VkDescriptorUpdateTemplateCreateInfoKHR templateInfo;
+      templateInfo.sType                      = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO_KHR;
+      templateInfo.pNext                      = nullptr;
+      templateInfo.flags                      = 0;
+      templateInfo.descriptorUpdateEntryCount = entries.size();
+      templateInfo.pDescriptorUpdateEntries   = entries.data();
+      templateInfo.templateType               = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET_KHR;
+      templateInfo.descriptorSetLayout        = m_descriptorSetLayout;
+      templateInfo.pipelineBindPoint          = VK_PIPELINE_BIND_POINT_GRAPHICS;
+      templateInfo.pipelineLayout             = m_pipelineLayout;
+      templateInfo.set                        = 0;
+      
+      // Not fatal, the context can still write descriptor
+      // sets the regular way if the template is undefined
+      if (m_vkd->vkCreateDescriptorUpdateTemplateKHR(m_vkd->device(),
+            &templateInfo, nullptr, &m_descriptorTemplate) != VK_SUCCESS) {
+        Logger::warn("DxvkPipelineLayout: Failed to create descriptor update template");
+        m_descriptorTemplate = VK_NULL_HANDLE;
+      }
+    }
   }
   
   
   DxvkPipelineLayout::~DxvkPipelineLayout() {
+    if (m_descriptorTemplate != VK_NULL_HANDLE) {
+      m_vkd->vkDestroyDescriptorUpdateTemplateKHR(
+        m_vkd->device(), m_descriptorTemplate, nullptr);
+    }
+    
     if (m_pipelineLayout != VK_NULL_HANDLE) {
       m_vkd->vkDestroyPipelineLayout(
         m_vkd->device(), m_pipelineLayout, nullptr);
@@ -91,6 +91,19 @@ namespace dxvk {
     uint32_t getBindingId(
             uint32_t              slot) const;
     
+    /**
+     * \brief Makes uniform buffer descriptors dynamic
+     * 
+     * Converts up to the given number of uniform buffer
+     * bindings to dynamic uniform buffers, so that they
+     * can be rebound by changing the dynamic offset when
+     * the underlying buffer gets renamed.
+     * \param [in] uniformBuffers Maximum number of
+     *        dynamic uniform buffers in the layout
+     */
+    void makeDescriptorsDynamic(
+            uint32_t              uniformBuffers);
+    
   private:
     
     std::vector<DxvkDescriptorSlot> m_descriptorSlots;
@@ -111,7 +124,8 @@ namespace dxvk {
     DxvkPipelineLayout(
       const Rc<vk::DeviceFn>&   vkd,
             uint32_t            bindingCount,
-      const DxvkDescriptorSlot* bindingInfos);
+      const DxvkDescriptorSlot* bindingInfos,
+            bool                useTemplate);
     
     ~DxvkPipelineLayout();
     
@@ -141,6 +155,28 @@ namespace dxvk {
       return m_bindingSlots.data();
     }
     
+    /**
+     * \brief Number of dynamic bindings
+     * 
+     * Dynamic offsets must be passed to the
+     * descriptor set binding command in the
+     * same order as the bindings themselves.
+     * \returns Dynamic descriptor count
+     */
+    uint32_t dynamicBindingCount() const {
+      return m_dynamicSlots.size();
+    }
+    
+    /**
+     * \brief Dynamic binding index
+     * 
+     * \param [in] id Dynamic binding number
+     * \returns Binding index of the descriptor
+     */
+    uint32_t dynamicBinding(uint32_t id) const {
+      return m_dynamicSlots[id];
+    }
+    
     /**
      * \brief Descriptor set layout handle
      * \returns Descriptor set layout handle
@@ -157,6 +193,19 @@ namespace dxvk {
       return m_pipelineLayout;
     }
     
+    /**
+     * \brief Descriptor update template
+     * 
+     * Writes all bindings of a descriptor set from
+     * a tightly packed array of descriptor infos,
+     * one per binding. Only available if the device
+     * supports \c VK_KHR_descriptor_update_template.
+     * \returns Update template, or \c VK_NULL_HANDLE
+     */
+    VkDescriptorUpdateTemplateKHR descriptorTemplate() const {
+      return m_descriptorTemplate;
+    }
+    
   private:
     
     Rc<vk::DeviceFn>      m_vkd;
@@ -164,7 +213,10 @@ namespace dxvk {
     VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
     VkPipelineLayout      m_pipelineLayout      = VK_NULL_HANDLE;
     
+    VkDescriptorUpdateTemplateKHR m_descriptorTemplate = VK_NULL_HANDLE;
+    
     std::vector<DxvkDescriptorSlot> m_bindingSlots;
+    std::vector<uint32_t>           m_dynamicSlots;
     
   };
   
@@ -1,11 +1,23 @@
+#include <chrono>
+
 #include "dxvk_device.h"
 #include "dxvk_queue.h"
 
 namespace dxvk {
   
+  using SubmitClock = std::chrono::high_resolution_clock;
+  
+  static uint64_t elapsedMicroseconds(
+          SubmitClock::time_point   t0,
+          SubmitClock::time_point   t1) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+  }
+  
+  
   DxvkSubmissionQueue::DxvkSubmissionQueue(DxvkDevice* device)
-  : m_device(device),
-    m_thread([this] () { threadFunc(); }) {
+  : m_device      (device),
+    m_submitThread([this] () { submitThreadFunc(); }),
+    m_finishThread([this] () { finishThreadFunc(); }) {
     
   }
   
@@ -16,39 +28,116 @@ namespace dxvk {
     }
     
     m_condOnAdd.notify_one();
-    m_thread.join();
+    m_condOnSubmit.notify_one();
+    
+    // The submission thread drains its queue before
+    // exiting, so it must be stopped first in order
+    // to not lose any command lists.
+    m_submitThread.join();
+    m_finishThread.join();
   }
   
   
-  void DxvkSubmissionQueue::submit(
-    const Rc<DxvkFence>&        fence,
-    const Rc<DxvkCommandList>&  cmdList) {
+  void DxvkSubmissionQueue::submit(DxvkSubmission&& submission) {
+    const auto t0 = SubmitClock::now();
+    
     { std::unique_lock<std::mutex> lock(m_mutex);
       
       m_condOnTake.wait(lock, [this] {
-        return m_entries.size() < MaxNumQueuedCommandBuffers;
+        return m_pending < MaxNumQueuedCommandBuffers;
       });
       
-      m_entries.push({ fence, cmdList });
+      m_pending += 1;
+      m_submitQueue.push(std::move(submission));
     }
     
     m_condOnAdd.notify_one();
+    
+    const auto t1 = SubmitClock::now();
+    m_enqueueTime += elapsedMicroseconds(t0, t1);
+  }
+  
+  
+  void DxvkSubmissionQueue::synchronize() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    m_condOnSync.wait(lock, [this] {
+      return m_submitQueue.size() == 0;
+    });
   }
   
   
-  void DxvkSubmissionQueue::threadFunc() {
+  void DxvkSubmissionQueue::waitForResource(const Rc<DxvkResource>& resource) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    m_condOnFinish.wait(lock, [&resource] {
+      return !resource->isInUse();
+    });
+  }
+  
+  
+  DxvkStatCounters DxvkSubmissionQueue::getStatCounters() const {
+    DxvkStatCounters result;
+    result.setCtr(DxvkStatCounter::QueueSubmitCount, m_submitCount.load());
+    result.setCtr(DxvkStatCounter::QueueSubmitTime,  m_submitTime.load());
+    result.setCtr(DxvkStatCounter::QueueEnqueueTime, m_enqueueTime.load());
+    return result;
+  }
+  
+  
+  void DxvkSubmissionQueue::submitThreadFunc() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    while (true) {
+      m_condOnAdd.wait(lock, [this] {
+        return m_stopped.load() || (m_submitQueue.size() != 0);
+      });
+      
+      if (m_submitQueue.size() == 0)
+        break;
+      
+      // Keep the entry in the queue until it is actually
+      // submitted so that synchronize() can wait for it
+      DxvkSubmission entry = m_submitQueue.front();
+      lock.unlock();
+      
+      const auto t0 = SubmitClock::now();
+      
+      { // Queue submissions are not thread safe
+        std::lock_guard<std::mutex> queueLock(m_device->m_submissionLock);
+        entry.cmdList->submit(entry.queue,
+          entry.waitSync, entry.wakeSync, entry.fence->handle());
+      }
+      
+      const auto t1 = SubmitClock::now();
+      
+      m_submitCount += 1;
+      m_submitTime  += elapsedMicroseconds(t0, t1);
+      
+      lock.lock();
+      m_submitQueue.pop();
+      m_finishQueue.push(std::move(entry));
+      
+      m_condOnSubmit.notify_one();
+      m_condOnSync.notify_all();
+    }
+  }
+  
+  
+  void DxvkSubmissionQueue::finishThreadFunc() {
     while (!m_stopped.load()) {
-      Entry entry;
+      DxvkSubmission entry;
       
       { std::unique_lock<std::mutex> lock(m_mutex);
         
-        m_condOnAdd.wait(lock, [this] {
-          return m_stopped.load() || (m_entries.size() != 0);
+        m_condOnSubmit.wait(lock, [this] {
+          return m_stopped.load() || (m_finishQueue.size() != 0);
         });
         
-        if (m_entries.size() != 0) {
-          entry = std::move(m_entries.front());
-          m_entries.pop();
+        if (m_finishQueue.size() != 0) {
+          entry = std::move(m_finishQueue.front());
+          m_finishQueue.pop();
+          m_pending -= 1;
         }
       }
       
@@ -63,8 +152,14 @@ namespace dxvk {
         entry.cmdList->reset();
         
         m_device->recycleCommandList(entry.cmdList);
+        
+        // Resetting the command list released all resources
+        // used by it, so wake up any threads waiting on them.
+        // Taking the lock ensures that the wakeup isn't lost.
+        { std::unique_lock<std::mutex> lock(m_mutex); }
+        m_condOnFinish.notify_all();
       }
     }
   }
   
-}
\ No newline at end of file
+}
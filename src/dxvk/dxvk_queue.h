@@ -6,16 +6,37 @@
 #include <thread>
 
 #include "dxvk_cmdlist.h"
+#include "dxvk_stats.h"
 #include "dxvk_sync.h"
 
 namespace dxvk {
   
   class DxvkDevice;
   
+  /**
+   * \brief Queue submission info
+   *
+   * Stores a command list along with the queue, fence
+   * and semaphores to use for the Vulkan submission.
+   */
+  struct DxvkSubmission {
+    VkQueue             queue;
+    Rc<DxvkFence>       fence;
+    Rc<DxvkCommandList> cmdList;
+    VkSemaphore         waitSync;
+    VkSemaphore         wakeSync;
+  };
+  
+  
   /**
    * \brief Submission queue
-   * 
-   * 
+   *
+   * Processes command lists in two stages, each with
+   * its own thread. The submission stage submits command
+   * lists to the device queue, so that the thread which
+   * recorded them never blocks in \c vkQueueSubmit. The
+   * completion stage waits for the command lists to be
+   * executed by the GPU and recycles them afterwards.
    */
   class DxvkSubmissionQueue {
     
@@ -24,29 +45,73 @@ namespace dxvk {
     DxvkSubmissionQueue(DxvkDevice* device);
     ~DxvkSubmissionQueue();
     
-    void submit(
-      const Rc<DxvkFence>&        fence,
-      const Rc<DxvkCommandList>&  cmdList);
+    /**
+     * \brief Queues a command list for submission
+     *
+     * Blocks if too many command lists are pending, so
+     * that the CPU cannot run too far ahead of the GPU.
+     * \param [in] submission The command list to submit
+     */
+    void submit(DxvkSubmission&& submission);
     
-  private:
+    /**
+     * \brief Waits for pending submissions
+     *
+     * Waits until all command lists queued so far have
+     * been submitted to the device queue. This must be
+     * called before any operation that requires these
+     * submissions to be visible to the Vulkan driver.
+     */
+    void synchronize();
     
-    struct Entry {
-      Rc<DxvkFence>       fence;
-      Rc<DxvkCommandList> cmdList;
-    };
+    /**
+     * \brief Waits for a resource to become idle
+     * 
+     * Blocks until all command lists using the resource
+     * have completed execution. This is woken up by the
+     * completion stage whenever a command list retires,
+     * so waiting threads do not consume any CPU time.
+     * \param [in] resource The resource to wait for
+     */
+    void waitForResource(const Rc<DxvkResource>& resource);
+    
+    /**
+     * \brief Retrieves submission statistics
+     *
+     * The time spent in \c vkQueueSubmit on the submission
+     * thread is the time that the CS thread would otherwise
+     * have spent blocking on submissions.
+     * \returns Stat counters
+     */
+    DxvkStatCounters getStatCounters() const;
+    
+  private:
     
     DxvkDevice*             m_device;
     
     std::atomic<bool>       m_stopped = { false };
+    uint32_t                m_pending = 0;
+    
+    std::atomic<uint64_t>   m_submitCount = { 0ull };
+    std::atomic<uint64_t>   m_submitTime  = { 0ull };
+    std::atomic<uint64_t>   m_enqueueTime = { 0ull };
     
     std::mutex              m_mutex;
     std::condition_variable m_condOnAdd;
     std::condition_variable m_condOnTake;
-    std::queue<Entry>       m_entries;
-    std::thread             m_thread;
+    std::condition_variable m_condOnSubmit;
+    std::condition_variable m_condOnSync;
+    std::condition_variable m_condOnFinish;
+    
+    std::queue<DxvkSubmission> m_submitQueue;
+    std::queue<DxvkSubmission> m_finishQueue;
+    
+    std::thread             m_submitThread;
+    std::thread             m_finishThread;
     
-    void threadFunc();
+    void submitThreadFunc();
+    void finishThreadFunc();
     
   };
   
-}
\ No newline at end of file
+}
@@ -0,0 +1,108 @@
+#include "dxvk_device.h"
+#include "dxvk_recorder.h"
+
+namespace dxvk {
+  
+  DxvkRecording::DxvkRecording(
+    const std::vector<Rc<DxvkCsChunk>>& chunks)
+  : m_chunks(chunks) {
+    
+  }
+  
+  
+  DxvkRecording::~DxvkRecording() {
+    
+  }
+  
+  
+  Rc<DxvkCommandList> DxvkRecording::takeCommandList() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    
+    m_cond.wait(lock, [this] {
+      return m_done;
+    });
+    
+    return std::exchange(m_cmdList, nullptr);
+  }
+  
+  
+  void DxvkRecording::complete(const Rc<DxvkCommandList>& cmdList) {
+    { std::unique_lock<std::mutex> lock(m_mutex);
+      m_cmdList = cmdList;
+      m_done    = true;
+      
+      // The chunks are still owned by the D3D11 command
+      // list, so we don't need to keep them alive here
+      m_chunks.clear();
+    }
+    
+    m_cond.notify_all();
+  }
+  
+  
+  DxvkRecorder::DxvkRecorder(const Rc<DxvkDevice>& device)
+  : m_device(device) {
+    // Leave some room for the application
+    // thread as well as the CS thread
+    const uint32_t threadCount = std::max(1u,
+      std::min(std::thread::hardware_concurrency() / 2, MaxNumThreads));
+    
+    for (uint32_t i = 0; i < threadCount; i++)
+      m_threads.emplace_back([this] () { threadFunc(); });
+  }
+  
+  
+  DxvkRecorder::~DxvkRecorder() {
+    { std::unique_lock<std::mutex> lock(m_mutex);
+      m_stopped.store(true);
+    }
+    
+    m_condOnAdd.notify_all();
+    
+    for (auto& thread : m_threads)
+      thread.join();
+  }
+  
+  
+  void DxvkRecorder::record(const Rc<DxvkRecording>& recording) {
+    { std::unique_lock<std::mutex> lock(m_mutex);
+      m_recordings.push(recording);
+    }
+    
+    m_condOnAdd.notify_one();
+  }
+  
+  
+  void DxvkRecorder::threadFunc() {
+    while (true) {
+      Rc<DxvkRecording> recording;
+      
+      { std::unique_lock<std::mutex> lock(m_mutex);
+        
+        m_condOnAdd.wait(lock, [this] {
+          return m_stopped.load() || (m_recordings.size() != 0);
+        });
+        
+        // Finish all pending recordings before exiting
+        // since another thread may be waiting for them
+        if (m_recordings.size() == 0)
+          return;
+        
+        recording = std::move(m_recordings.front());
+        m_recordings.pop();
+      }
+      
+      // Each recording starts with the default context state,
+      // just like a D3D11 command list. Contexts are cheap to
+      // create, so we don't need to reset and reuse them.
+      Rc<DxvkContext> context = m_device->createContext();
+      context->beginRecording(m_device->createCommandList());
+      
+      for (const auto& chunk : recording->m_chunks)
+        chunk->executeAll(context.ptr());
+      
+      recording->complete(context->endRecording());
+    }
+  }
+  
+}
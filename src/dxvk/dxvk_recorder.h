@@ -0,0 +1,107 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "dxvk_cmdlist.h"
+#include "dxvk_cs.h"
+
+namespace dxvk {
+  
+  class DxvkDevice;
+  
+  /**
+   * \brief Command list recording
+   *
+   * Stores a sequence of CS chunks which are
+   * translated into a Vulkan command list on
+   * one of the threads of a \ref DxvkRecorder.
+   */
+  class DxvkRecording : public RcObject {
+    friend class DxvkRecorder;
+  public:
+    
+    DxvkRecording(
+      const std::vector<Rc<DxvkCsChunk>>& chunks);
+    ~DxvkRecording();
+    
+    /**
+     * \brief Takes the recorded command list
+     *
+     * Waits for the recording to be completed and
+     * transfers ownership of the command list to the
+     * caller. Since Vulkan command lists are recorded
+     * for one-time submission, subsequent calls will
+     * return \c nullptr.
+     * \returns The recorded command list
+     */
+    Rc<DxvkCommandList> takeCommandList();
+  
+  private:
+    
+    std::vector<Rc<DxvkCsChunk>> m_chunks;
+    
+    std::mutex              m_mutex;
+    std::condition_variable m_cond;
+    
+    bool                    m_done = false;
+    Rc<DxvkCommandList>     m_cmdList;
+    
+    void complete(const Rc<DxvkCommandList>& cmdList);
+    
+  };
+  
+  
+  /**
+   * \brief Command list recorder
+   *
+   * Manages a pool of worker threads which execute CS
+   * chunks on their own contexts. This allows recording
+   * multiple Vulkan command lists in parallel when the
+   * application uses D3D11 deferred contexts.
+   * 
+   * Workers resolve buffer slices and views and track
+   * resources when executing the chunks, so recordings
+   * must be queued from the thread which owns resource
+   * state, i.e. the CS thread, and that thread must not
+   * rename or move any buffers until the recordings have
+   * completed. The recorded command lists must be submitted.
+   */
+  class DxvkRecorder : public RcObject {
+    // Upper limit for the number of worker threads
+    constexpr static uint32_t MaxNumThreads = 8;
+  public:
+    
+    DxvkRecorder(const Rc<DxvkDevice>& device);
+    ~DxvkRecorder();
+    
+    /**
+     * \brief Queues a recording
+     *
+     * The recording will be processed by the next
+     * available worker thread. Use the recording's
+     * \ref DxvkRecording::takeCommandList method
+     * to retrieve the resulting command list.
+     * \param [in] recording The recording
+     */
+    void record(const Rc<DxvkRecording>& recording);
+  
+  private:
+    
+    const Rc<DxvkDevice>        m_device;
+    
+    std::atomic<bool>           m_stopped = { false };
+    
+    std::mutex                  m_mutex;
+    std::condition_variable     m_condOnAdd;
+    std::queue<Rc<DxvkRecording>> m_recordings;
+    std::vector<std::thread>    m_threads;
+    
+    void threadFunc();
+    
+  };
+  
+}
@@ -43,11 +43,151 @@ namespace dxvk {
   }
   
   
+  bool DxvkStagingBuffer::alloc(
+          VkDeviceSize            size,
+          DxvkBufferSlice&        slice) {
+    if (m_bufferOffset + size > m_bufferSize)
+      return false;
+    
+    slice = DxvkBufferSlice(m_buffer, m_bufferOffset, size);
+    
+    m_bufferOffset = align(m_bufferOffset + size, 64);
+    return true;
+  }
+  
+  
   void DxvkStagingBuffer::reset() {
     m_bufferOffset = 0;
   }
   
   
+  DxvkStagingRing::DxvkStagingRing(DxvkDevice* device)
+  : m_device(device) {
+    
+  }
+  
+  
+  DxvkStagingRing::~DxvkStagingRing() {
+    
+  }
+  
+  
+  Rc<DxvkStagingBuffer> DxvkStagingRing::acquire(VkDeviceSize size) {
+    uint32_t sizeClass = 0;
+    
+    while (sizeClass < SizeClassCount && getClassSize(sizeClass) < size)
+      sizeClass += 1;
+    
+    // Uploads that do not fit into any size class are rare,
+    // so there is no point in keeping their buffers around.
+    if (sizeClass == SizeClassCount)
+      return this->createBuffer(size);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SizeClass& ring = m_classes[sizeClass];
+    
+    // A buffer can be reused once the ring holds the only reference
+    // to it. Command lists release their staging buffers when they
+    // get reset after their fence has been signaled, and no new
+    // references can be created without going through the ring.
+    // Slices handed out as buffer slices keep the buffer in use
+    // until they are released as well, which can only happen
+    // after the staging buffer itself has been released.
+    for (size_t i = 0; i < ring.entries.size(); i++) {
+      const size_t entryId = (ring.next + i) % ring.entries.size();
+      Entry& entry = ring.entries[entryId];
+      
+      if (entry.buffer->refCount() == 1 && !entry.buffer->isInUse()) {
+        if (entryId < ring.next || entryId + 1 == ring.entries.size())
+          m_wraparounds += 1;
+        
+        ring.next = (entryId + 1) % ring.entries.size();
+        
+        entry.buffer->reset();
+        entry.frameId = m_frameId;
+        return entry.buffer;
+      }
+    }
+    
+    // All buffers are still in use, so we need to grow the ring.
+    // The new buffer is inserted at the current position so that
+    // the remaining buffers are still reused in submission order.
+    Entry entry;
+    entry.buffer  = this->createBuffer(getClassSize(sizeClass));
+    entry.frameId = m_frameId;
+    
+    ring.entries.insert(ring.entries.begin() + ring.next, entry);
+    ring.next = (ring.next + 1) % ring.entries.size();
+    return entry.buffer;
+  }
+  
+  
+  void DxvkStagingRing::endFrame(uint64_t frameId) {
+    const uint64_t frameBytes = m_frameBytes.exchange(0);
+    
+    m_lastFrameBytes  = frameBytes;
+    m_totalBytes     += frameBytes;
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frameId = frameId;
+    
+    for (SizeClass& ring : m_classes) {
+      size_t dstId = 0;
+      
+      for (size_t srcId = 0; srcId < ring.entries.size(); srcId++) {
+        const Entry& entry = ring.entries[srcId];
+        
+        if (entry.buffer->refCount() == 1
+         && !entry.buffer->isInUse()
+         && entry.frameId + RetireFrames < frameId) {
+          if (srcId < ring.next)
+            ring.next -= 1;
+          continue;
+        }
+        
+        if (dstId != srcId)
+          ring.entries[dstId] = entry;
+        dstId += 1;
+      }
+      
+      ring.entries.resize(dstId);
+      
+      if (ring.next >= ring.entries.size())
+        ring.next = 0;
+    }
+  }
+  
+  
+  DxvkStatCounters DxvkStagingRing::getStatCounters() const {
+    DxvkStatCounters result;
+    result.setCtr(DxvkStatCounter::StagingBytes,      m_totalBytes.load() + m_frameBytes.load());
+    result.setCtr(DxvkStatCounter::StagingFrameBytes, m_lastFrameBytes.load());
+    result.setCtr(DxvkStatCounter::StagingRingWraps,  m_wraparounds.load());
+    result.setCtr(DxvkStatCounter::StagingAllocCount, m_allocations.load());
+    return result;
+  }
+  
+  
+  Rc<DxvkStagingBuffer> DxvkStagingRing::createBuffer(VkDeviceSize size) {
+    // Staging buffers only need to be able to handle transfer
+    // operations, and they need to be in host-visible memory.
+    DxvkBufferCreateInfo info;
+    info.size   = size;
+    info.usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT
+                | VK_PIPELINE_STAGE_HOST_BIT;
+    info.access = VK_ACCESS_TRANSFER_READ_BIT
+                | VK_ACCESS_HOST_WRITE_BIT;
+    
+    VkMemoryPropertyFlags memFlags
+      = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+      | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    
+    m_allocations += 1;
+    return new DxvkStagingBuffer(m_device->createBuffer(info, memFlags));
+  }
+  
+  
   DxvkStagingAlloc::DxvkStagingAlloc(DxvkDevice* device)
   : m_device(device) { }
   
@@ -68,9 +208,9 @@ namespace dxvk {
         selectedBuffer = buf;
     }
     
-    // If we have no suitable buffer, allocate one from the device
-    // that is *at least* as large as the amount of data we need
-    // to upload. Usually it will be bigger.
+    // If we have no suitable buffer, get one from the device's
+    // staging ring that is *at least* as large as the amount of
+    // data we need to upload. Usually it will be bigger.
     DxvkStagingBufferSlice slice;
     
     if ((selectedBuffer == nullptr) || (!selectedBuffer->alloc(size, slice))) {
@@ -79,15 +219,41 @@ namespace dxvk {
       m_stagingBuffers.push_back(selectedBuffer);
     }
     
+    m_device->countStagedBytes(size);
     return slice;
   }
   
   
   void DxvkStagingAlloc::reset() {
-    for (const auto& buf : m_stagingBuffers)
-      m_device->recycleStagingBuffer(buf);
-    
+    // Dropping our references is enough to
+    // return the buffers to the staging ring
     m_stagingBuffers.resize(0);
   }
   
+  
+  DxvkStagingDataAlloc::DxvkStagingDataAlloc(DxvkDevice* device)
+  : m_device(device) {
+    
+  }
+  
+  
+  DxvkStagingDataAlloc::~DxvkStagingDataAlloc() {
+    
+  }
+  
+  
+  DxvkBufferSlice DxvkStagingDataAlloc::alloc(VkDeviceSize size) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    DxvkBufferSlice slice;
+    
+    if ((m_buffer == nullptr) || (!m_buffer->alloc(size, slice))) {
+      m_buffer = m_device->allocStagingBuffer(size);
+      m_buffer->alloc(size, slice);
+    }
+    
+    m_device->countStagedBytes(size);
+    return slice;
+  }
+  
 }
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "dxvk_buffer.h"
+#include "dxvk_stats.h"
 
 namespace dxvk {
   
@@ -60,6 +66,33 @@ namespace dxvk {
             VkDeviceSize            size,
             DxvkStagingBufferSlice& slice);
     
+    /**
+     * \brief Allocates a staging buffer slice
+     * 
+     * Same as above, but the slice keeps a reference to
+     * the underlying buffer, so that it can be tracked
+     * by command lists like any other buffer.
+     * \param [in] size Requested allocation size
+     * \param [out] slice Allocated buffer slice
+     * \returns \c true on success, \c false on failure
+     */
+    bool alloc(
+            VkDeviceSize            size,
+            DxvkBufferSlice&        slice);
+    
+    /**
+     * \brief Checks whether the buffer is in use
+     * 
+     * Returns \c true if any slice allocated via
+     * \ref alloc is still referenced, or if the
+     * GPU may still be reading from the buffer.
+     * \returns \c true if the buffer is in use
+     */
+    bool isInUse() const {
+      return m_buffer->refCount() > 1
+          || m_buffer->isInUse();
+    }
+    
     /**
      * \brief Resets staging buffer
      * 
@@ -78,11 +111,120 @@ namespace dxvk {
   };
   
   
+  /**
+   * \brief Staging buffer ring
+   * 
+   * Device-wide pool of persistent staging buffers. Buffers
+   * are grouped into size classes, and each size class is
+   * used as a ring: a buffer is handed out again once all
+   * command lists that used it have been reset, i.e. once
+   * their fence has been signaled. This way, steady-state
+   * streaming does not allocate any new Vulkan memory.
+   * 
+   * Buffers that have not been used for a number of frames
+   * are released again, so that a spike in upload traffic
+   * does not waste host memory for the rest of the session.
+   */
+  class DxvkStagingRing {
+    
+  public:
+    
+    /// Size of the smallest staging buffers
+    constexpr static VkDeviceSize MinBufferSize = 4 << 20;
+    
+    DxvkStagingRing(DxvkDevice* device);
+    ~DxvkStagingRing();
+    
+    /**
+     * \brief Acquires a staging buffer
+     * 
+     * Returns an unused staging buffer from the smallest
+     * size class that can hold the given amount of data.
+     * Requests larger than the biggest size class get a
+     * dedicated buffer which is not retained.
+     * \param [in] size Minimum buffer size
+     * \returns The staging buffer
+     */
+    Rc<DxvkStagingBuffer> acquire(
+            VkDeviceSize      size);
+    
+    /**
+     * \brief Counts staged bytes
+     * 
+     * Called for each staging buffer slice
+     * that is handed out to a command list.
+     * \param [in] size Number of bytes staged
+     */
+    void countStagedBytes(
+            VkDeviceSize      size) {
+      m_frameBytes += size;
+    }
+    
+    /**
+     * \brief Ends the current frame
+     * 
+     * Updates per-frame statistics and releases
+     * buffers that have not been used recently.
+     * \param [in] frameId The new frame ID
+     */
+    void endFrame(
+            uint64_t          frameId);
+    
+    /**
+     * \brief Retrieves staging statistics
+     * \returns Stat counters
+     */
+    DxvkStatCounters getStatCounters() const;
+    
+  private:
+    
+    /// Number of size classes. Each class is
+    /// four times as large as the previous one.
+    constexpr static uint32_t SizeClassCount = 4;
+    
+    /// Number of frames after which an unused
+    /// buffer is released
+    constexpr static uint64_t RetireFrames = 256;
+    
+    struct Entry {
+      Rc<DxvkStagingBuffer> buffer;
+      uint64_t              frameId;
+    };
+    
+    struct SizeClass {
+      std::vector<Entry> entries;
+      size_t             next = 0;
+    };
+    
+    DxvkDevice* m_device;
+    
+    std::mutex                            m_mutex;
+    std::array<SizeClass, SizeClassCount> m_classes;
+    uint64_t                              m_frameId = 0;
+    
+    std::atomic<uint64_t> m_frameBytes     = { 0ull };
+    std::atomic<uint64_t> m_lastFrameBytes = { 0ull };
+    std::atomic<uint64_t> m_totalBytes     = { 0ull };
+    std::atomic<uint64_t> m_wraparounds    = { 0ull };
+    std::atomic<uint64_t> m_allocations    = { 0ull };
+    
+    Rc<DxvkStagingBuffer> createBuffer(
+            VkDeviceSize      size);
+    
+    static VkDeviceSize getClassSize(
+            uint32_t          sizeClass) {
+      return MinBufferSize << (2 * sizeClass);
+    }
+    
+  };
+  
+  
   /**
    * \brief Staging buffer allocator
    * 
    * Convenient allocator for staging buffer slices
-   * which creates new staging buffers on demand.
+   * which acquires staging buffers from the device's
+   * staging ring on demand.
    */
   class DxvkStagingAlloc {
     
@@ -94,7 +236,7 @@ namespace dxvk {
     /**
      * \brief Allocates a staging buffer slice
      * 
-     * This \e may create a new staging buffer
+     * This \e may acquire a new staging buffer
      * if needed. This method should not fail.
      * \param [in] size Required amount of memory
      * \returns Allocated staging buffer slice
@@ -105,8 +247,8 @@ namespace dxvk {
     /**
      * \brief Resets staging buffer allocator
      * 
-     * Returns all buffers to the device so that
-     * they can be recycled. Buffers must not be
+     * Releases all buffers so that the staging ring
+     * can hand them out again. Buffers must not be
      * in use when this is called.
      */
     void reset();
@@ -119,4 +261,44 @@ namespace dxvk {
     
   };
   
+  
+  /**
+   * \brief Staging data allocator
+   * 
+   * Thread-safe allocator for host-visible buffer slices
+   * that can be filled by the host before any commands
+   * using them are recorded. This allows threads to copy
+   * data into staging memory in parallel, and only take
+   * a lock in order to record the actual copy commands.
+   * 
+   * Buffers are acquired from the device's staging ring,
+   * which hands them out again once no slice of them is
+   * referenced anymore.
+   */
+  class DxvkStagingDataAlloc {
+    
+  public:
+    
+    DxvkStagingDataAlloc(DxvkDevice* device);
+    ~DxvkStagingDataAlloc();
+    
+    /**
+     * \brief Allocates a staging data slice
+     * 
+     * This \e may acquire a new staging buffer
+     * if needed. This method should not fail.
+     * \param [in] size Slice size, in bytes
+     * \returns The buffer slice
+     */
+    DxvkBufferSlice alloc(VkDeviceSize size);
+    
+  private:
+    
+    DxvkDevice* const m_device;
+    
+    std::mutex            m_mutex;
+    Rc<DxvkStagingBuffer> m_buffer;
+    
+  };
+  
 }
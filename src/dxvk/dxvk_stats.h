@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+
+#include "dxvk_include.h"
+
+namespace dxvk {
+  
+  /**
+   * \brief Named stat counters
+   * 
+   * Enumerates available stat counters. Used
+   * together with \ref DxvkStatCounters.
+   */
+  enum class DxvkStatCounter : uint32_t {
+    CsChunkPoolHits,      ///< Chunks served from the chunk pool
+    CsChunkPoolMisses,    ///< Chunks allocated because the pool was empty
+    BufferRenameCount,    ///< Buffer discards served from the renaming pool
+    BufferReallocCount,   ///< Backing buffers allocated for discarded buffers
+    QueueSubmitCount,     ///< Command lists submitted by the submission thread
+    QueueSubmitTime,      ///< Time spent in vkQueueSubmit, in microseconds
+    QueueEnqueueTime,     ///< Time spent queueing submissions, in microseconds
+    MemoryDemotionCount,  ///< Allocations demoted to system memory
+    MemoryOverBudget,     ///< Allocations exceeding the heap budget
+    MemoryMovedBuffers,   ///< Buffers moved by the defragmenter
+    MemoryMovedBytes,     ///< Bytes moved by the defragmenter
+    StagingBytes,         ///< Bytes uploaded through staging buffers
+    StagingFrameBytes,    ///< Bytes uploaded through staging buffers in the last frame
+    StagingRingWraps,     ///< Number of times a staging ring wrapped around
+    StagingAllocCount,    ///< Staging buffers allocated by the staging ring
+    DescSetCacheHits,     ///< Descriptor sets reused from the descriptor set cache
+    DescSetCacheMisses,   ///< Descriptor sets that had to be allocated and written
+    NumCounters,          ///< Number of counters available
+  };
+  
+  
+  /**
+   * \brief Stat counters
+   * 
+   * Collects various statistics that may be
+   * useful to identify performance bottlenecks.
+   */
+  class DxvkStatCounters {
+    
+  public:
+    
+    DxvkStatCounters();
+    ~DxvkStatCounters();
+    
+    /**
+     * \brief Retrieves a counter value
+     * 
+     * \param [in] ctr The counter
+     * \returns Counter value
+     */
+    uint64_t getCtr(DxvkStatCounter ctr) const {
+      return m_counters[uint32_t(ctr)];
+    }
+    
+    /**
+     * \brief Sets a counter value
+     * 
+     * \param [in] ctr The counter
+     * \param [in] val Counter value
+     */
+    void setCtr(DxvkStatCounter ctr, uint64_t val) {
+      m_counters[uint32_t(ctr)] = val;
+    }
+    
+    /**
+     * \brief Increments a counter value
+     * 
+     * \param [in] ctr Counter to increment
+     * \param [in] val Number to add to counter value
+     */
+    void addCtr(DxvkStatCounter ctr, uint64_t val) {
+      m_counters[uint32_t(ctr)] += val;
+    }
+    
+    /**
+     * \brief Computes difference
+     * 
+     * Computes difference between counter values.
+     * \param [in] other Counters to subtract
+     * \returns Difference between counter sets
+     */
+    DxvkStatCounters diff(const DxvkStatCounters& other) const;
+    
+    /**
+     * \brief Merges counters
+     * 
+     * Adds counter values from another set
+     * of counters to this set of counters.
+     * \param [in] other Counters to add
+     */
+    void merge(const DxvkStatCounters& other);
+    
+    /**
+     * \brief Resets counters
+     * 
+     * Sets all counters to zero.
+     */
+    void reset();
+    
+  private:
+    
+    std::array<uint64_t, uint32_t(DxvkStatCounter::NumCounters)> m_counters;
+    
+  };
+  
+}
@@ -0,0 +1,129 @@
+#include "dxvk_device.h"
+#include "dxvk_uniform_ring.h"
+
+namespace dxvk {
+  
+  DxvkUniformRing::DxvkUniformRing(DxvkDevice* device)
+  : m_device(device) {
+    
+  }
+  
+  
+  DxvkUniformRing::~DxvkUniformRing() {
+    
+  }
+  
+  
+  bool DxvkUniformRing::alloc(
+          VkDeviceSize              size,
+          DxvkPhysicalBufferSlice&  slice) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    const VkDeviceSize alignedSize = align(size, SliceAlignment);
+    
+    bool realloc = false;
+    
+    if (m_offset + alignedSize > ChunkSize) {
+      const size_t chunkCount = m_chunks.size();
+      
+      if (!this->advance())
+        return false;
+      
+      realloc = m_chunks.size() != chunkCount;
+    }
+    
+    Chunk& chunk = m_chunks[m_chunkId];
+    chunk.frameId = m_frameId;
+    
+    slice = chunk.buffer->slice(m_offset, size);
+    m_offset += alignedSize;
+    
+    m_device->countBufferDiscards(1, realloc ? 1 : 0);
+    return true;
+  }
+  
+  
+  void DxvkUniformRing::endFrame(uint64_t frameId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_frameId = frameId;
+    
+    size_t dstId = 0;
+    
+    for (size_t srcId = 0; srcId < m_chunks.size(); srcId++) {
+      const Chunk& chunk = m_chunks[srcId];
+      
+      if (chunk.buffer->refCount() == 1
+       && chunk.frameId + RetireFrames < frameId) {
+        // The current chunk has been idle as well,
+        // so the next allocation has to advance.
+        if (srcId == m_chunkId)
+          m_offset = ChunkSize;
+        continue;
+      }
+      
+      if (srcId == m_chunkId)
+        m_chunkId = dstId;
+      
+      if (dstId != srcId)
+        m_chunks[dstId] = chunk;
+      dstId += 1;
+    }
+    
+    m_chunks.resize(dstId);
+    
+    if (m_chunkId >= m_chunks.size())
+      m_chunkId = 0;
+  }
+  
+  
+  bool DxvkUniformRing::advance() {
+    // A chunk can be reused once the ring holds the only reference
+    // to it. Buffers keep their current slice alive, and command
+    // lists release their references once their fence signals.
+    // No new references can be created without going through the
+    // ring, so the check cannot race with other threads.
+    for (size_t i = 1; i <= m_chunks.size(); i++) {
+      const size_t chunkId = (m_chunkId + i) % m_chunks.size();
+      
+      if (m_chunks[chunkId].buffer->refCount() == 1) {
+        m_chunkId = chunkId;
+        m_offset  = 0;
+        return true;
+      }
+    }
+    
+    if (m_chunks.size() >= MaxChunkCount)
+      return false;
+    
+    Chunk chunk;
+    chunk.buffer  = this->createChunk();
+    chunk.frameId = m_frameId;
+    
+    m_chunks.push_back(chunk);
+    m_chunkId = m_chunks.size() - 1;
+    m_offset  = 0;
+    return true;
+  }
+  
+  
+  Rc<DxvkPhysicalBuffer> DxvkUniformRing::createChunk() const {
+    DxvkBufferCreateInfo info;
+    info.size   = ChunkSize;
+    info.usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+                | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+                | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    info.stages = VK_PIPELINE_STAGE_HOST_BIT
+                | VK_PIPELINE_STAGE_TRANSFER_BIT
+                | VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT
+                | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    info.access = VK_ACCESS_HOST_WRITE_BIT
+                | VK_ACCESS_TRANSFER_READ_BIT
+                | VK_ACCESS_TRANSFER_WRITE_BIT
+                | VK_ACCESS_UNIFORM_READ_BIT;
+    
+    return m_device->allocPhysicalBuffer(info,
+      VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+    | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  }
+  
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "dxvk_buffer_res.h"
+
+namespace dxvk {
+  
+  class DxvkDevice;
+  
+  /**
+   * \brief Uniform buffer upload ring
+   * 
+   * Sub-allocates slices for small uniform buffers from a
+   * set of host-visible buffers, so that discarding a
+   * constant buffer does not require allocating a new
+   * physical buffer. Slices are handed out linearly, and
+   * a ring buffer can be reused as soon as it is no longer
+   * referenced by any buffer or pending command list.
+   * 
+   * The number of ring buffers is limited, and buffers
+   * which have not been used for a number of frames are
+   * released again.
+   */
+  class DxvkUniformRing {
+    
+  public:
+    
+    /// Maximum size of a single slice
+    constexpr static VkDeviceSize MaxSliceSize = 16384;
+    
+    DxvkUniformRing(DxvkDevice* device);
+    ~DxvkUniformRing();
+    
+    /**
+     * \brief Allocates a uniform buffer slice
+     * 
+     * The slice is aligned to 256 bytes, which satisfies
+     * the uniform buffer offset alignment requirements.
+     * Fails if all ring buffers are still in use and no
+     * new ring buffer can be created.
+     * \param [in] size Slice size, in bytes. Must not
+     *        be larger than \ref MaxSliceSize.
+     * \param [out] slice The buffer slice
+     * \returns \c true on success, \c false on failure
+     */
+    bool alloc(
+            VkDeviceSize              size,
+            DxvkPhysicalBufferSlice&  slice);
+    
+    /**
+     * \brief Ends the current frame
+     * 
+     * Releases ring buffers that are not in
+     * use and have not been used recently.
+     * \param [in] frameId The new frame ID
+     */
+    void endFrame(
+            uint64_t                  frameId);
+    
+  private:
+    
+    constexpr static VkDeviceSize ChunkSize      = 1 << 20;
+    constexpr static VkDeviceSize SliceAlignment = 256;
+    
+    /// Maximum number of ring buffers
+    constexpr static size_t MaxChunkCount = 32;
+    
+    /// Number of frames after which an unused
+    /// ring buffer is released
+    constexpr static uint64_t RetireFrames = 256;
+    
+    struct Chunk {
+      Rc<DxvkPhysicalBuffer> buffer;
+      uint64_t               frameId;
+    };
+    
+    DxvkDevice* m_device;
+    
+    std::mutex          m_mutex;
+    std::vector<Chunk>  m_chunks;
+    size_t              m_chunkId = 0;
+    VkDeviceSize        m_offset  = ChunkSize;
+    uint64_t            m_frameId = 0;
+    
+    bool advance();
+    
+    Rc<DxvkPhysicalBuffer> createChunk() const;
+    
+  };
+  
+}
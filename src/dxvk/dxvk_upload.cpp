@@ -0,0 +1,202 @@
+#include "dxvk_device.h"
+#include "dxvk_upload.h"
+
+namespace dxvk {
+  
+  DxvkUploader::DxvkUploader(DxvkDevice* device)
+  : m_device              (device),
+    m_transferQueueFamily (device->adapter()->transferQueueFamily()),
+    m_graphicsQueueFamily (device->adapter()->graphicsQueueFamily()) {
+  
+  }
+  
+  
+  DxvkUploader::~DxvkUploader() {
+  
+  }
+  
+  
+  void DxvkUploader::uploadBuffer(
+    const Rc<DxvkBuffer>&           buffer,
+          VkDeviceSize              offset,
+          VkDeviceSize              size,
+    const DxvkBufferSlice&          source) {
+    const DxvkPhysicalBufferSlice dstSlice = buffer->subSlice(offset, size);
+    const DxvkPhysicalBufferSlice srcSlice = source.physicalSlice();
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->beginUpload();
+    
+    VkBufferCopy region;
+    region.srcOffset = srcSlice.offset();
+    region.dstOffset = dstSlice.offset();
+    region.size      = size;
+    
+    m_transferCmd->cmdCopyBuffer(
+      srcSlice.handle(),
+      dstSlice.handle(),
+      1, &region);
+    
+    // Release the buffer range to the graphics queue. The
+    // acquire barrier must use the same queue families and
+    // buffer range, but has its own access masks.
+    VkBufferMemoryBarrier barrier;
+    barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    barrier.pNext               = nullptr;
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = 0;
+    barrier.srcQueueFamilyIndex = m_transferQueueFamily;
+    barrier.dstQueueFamilyIndex = m_graphicsQueueFamily;
+    barrier.buffer              = dstSlice.handle();
+    barrier.offset              = dstSlice.offset();
+    barrier.size                = dstSlice.length();
+    
+    m_transferCmd->cmdPipelineBarrier(
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+      0, nullptr, 1, &barrier, 0, nullptr);
+    
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = buffer->info().access;
+    m_acquireBuffers.push_back(barrier);
+    m_acquireStages |= buffer->info().stages;
+    
+    m_transferCmd->trackResource(srcSlice.resource());
+    m_transferCmd->trackResource(dstSlice.resource());
+    m_acquireCmd->trackResource(dstSlice.resource());
+    
+    this->endUpload();
+  }
+  
+  
+  void DxvkUploader::uploadImage(
+    const Rc<DxvkImage>&            image,
+    const VkImageSubresourceLayers& subresources,
+    const DxvkBufferSlice&          source) {
+    const DxvkPhysicalBufferSlice srcSlice = source.physicalSlice();
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->beginUpload();
+    
+    VkImageMemoryBarrier barrier;
+    barrier.sType                           = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.pNext                           = nullptr;
+    barrier.srcAccessMask                   = 0;
+    barrier.dstAccessMask                   = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.oldLayout                       = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout                       = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex             = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image                           = image->handle();
+    barrier.subresourceRange.aspectMask     = subresources.aspectMask;
+    barrier.subresourceRange.baseMipLevel   = subresources.mipLevel;
+    barrier.subresourceRange.levelCount     = 1;
+    barrier.subresourceRange.baseArrayLayer = subresources.baseArrayLayer;
+    barrier.subresourceRange.layerCount     = subresources.layerCount;
+    
+    m_transferCmd->cmdPipelineBarrier(
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+      0, nullptr, 0, nullptr, 1, &barrier);
+    
+    // Copying entire subresources is always valid,
+    // regardless of the queue's image transfer
+    // granularity, which may be coarse on DMA queues.
+    VkBufferImageCopy region;
+    region.bufferOffset       = srcSlice.offset();
+    region.bufferRowLength    = 0;
+    region.bufferImageHeight  = 0;
+    region.imageSubresource   = subresources;
+    region.imageOffset        = VkOffset3D { 0, 0, 0 };
+    region.imageExtent        = image->mipLevelExtent(subresources.mipLevel);
+    
+    m_transferCmd->cmdCopyBufferToImage(
+      srcSlice.handle(), image->handle(),
+      VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+      1, &region);
+    
+    // Release the image to the graphics queue. The layout
+    // transition is performed as part of the ownership
+    // transfer, so the acquire barrier must use the same
+    // layouts as the release barrier.
+    barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask       = 0;
+    barrier.oldLayout           = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout           = image->info().layout;
+    barrier.srcQueueFamilyIndex = m_transferQueueFamily;
+    barrier.dstQueueFamilyIndex = m_graphicsQueueFamily;
+    
+    m_transferCmd->cmdPipelineBarrier(
+      VK_PIPELINE_STAGE_TRANSFER_BIT,
+      VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+      0, nullptr, 0, nullptr, 1, &barrier);
+    
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = image->info().access;
+    m_acquireImages.push_back(barrier);
+    m_acquireStages |= image->info().stages;
+    
+    m_transferCmd->trackResource(srcSlice.resource());
+    m_transferCmd->trackResource(image);
+    m_acquireCmd->trackResource(image);
+    
+    this->endUpload();
+  }
+  
+  
+  void DxvkUploader::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    if (m_uploadCount != 0)
+      this->submit();
+  }
+  
+  
+  void DxvkUploader::beginUpload() {
+    if (m_transferCmd == nullptr) {
+      m_transferCmd = m_device->createTransferCommandList();
+      m_transferCmd->beginRecording();
+      
+      m_acquireCmd = m_device->createCommandList();
+      m_acquireCmd->beginRecording();
+    }
+  }
+  
+  
+  void DxvkUploader::endUpload() {
+    // Submit large batches early so that the
+    // transfer queue can start working on them
+    if (++m_uploadCount >= MaxPendingUploads)
+      this->submit();
+  }
+  
+  
+  void DxvkUploader::submit() {
+    Rc<DxvkSemaphore> semaphore = new DxvkSemaphore(m_device->vkd());
+    
+    m_transferCmd->endRecording();
+    m_device->submitTransferCommandList(m_transferCmd, semaphore);
+    
+    // The semaphore wait only blocks the acquire command list,
+    // but since the acquire barrier's destination scope covers
+    // all subsequent commands on the graphics queue, any use
+    // of the resources is ordered after the uploads.
+    m_acquireCmd->cmdPipelineBarrier(
+      VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+      m_acquireStages, 0, 0, nullptr,
+      m_acquireBuffers.size(), m_acquireBuffers.data(),
+      m_acquireImages.size(),  m_acquireImages.data());
+    
+    m_acquireCmd->endRecording();
+    m_device->submitCommandList(m_acquireCmd, semaphore, nullptr);
+    
+    m_transferCmd = nullptr;
+    m_acquireCmd  = nullptr;
+    m_uploadCount = 0;
+    
+    m_acquireBuffers.clear();
+    m_acquireImages.clear();
+    m_acquireStages = 0;
+  }
+  
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "dxvk_buffer.h"
+#include "dxvk_cmdlist.h"
+#include "dxvk_image.h"
+
+namespace dxvk {
+  
+  class DxvkDevice;
+  
+  /**
+   * \brief Asynchronous resource uploader
+   * 
+   * Records initial data uploads from staging buffers
+   * into command lists for the dedicated transfer queue.
+   * When flushed, the upload command list signals a
+   * semaphore which a small command list on the graphics
+   * queue waits on before acquiring ownership of the
+   * uploaded resources, so that uploads do not have to
+   * wait for any rendering work to finish.
+   * 
+   * Only use this for resources that have just been
+   * created and are not yet in use by the GPU, since
+   * all previous contents will be discarded.
+   */
+  class DxvkUploader {
+    
+  public:
+    
+    DxvkUploader(DxvkDevice* device);
+    ~DxvkUploader();
+    
+    /**
+     * \brief Uploads buffer data
+     * 
+     * \param [in] buffer The buffer to write to
+     * \param [in] offset Offset of the region to update
+     * \param [in] size Size of the region to update
+     * \param [in] source Staging buffer slice holding the data
+     */
+    void uploadBuffer(
+      const Rc<DxvkBuffer>&           buffer,
+            VkDeviceSize              offset,
+            VkDeviceSize              size,
+      const DxvkBufferSlice&          source);
+    
+    /**
+     * \brief Uploads image data
+     * 
+     * Writes the entire given mip level of one
+     * or more array layers of the image.
+     * \param [in] image The image to write to
+     * \param [in] subresources Subresources to update
+     * \param [in] source Staging buffer slice holding
+     *        the tightly packed pixels or blocks
+     */
+    void uploadImage(
+      const Rc<DxvkImage>&            image,
+      const VkImageSubresourceLayers& subresources,
+      const DxvkBufferSlice&          source);
+    
+    /**
+     * \brief Submits pending uploads
+     * 
+     * Submits the transfer command list as well as the
+     * command list which acquires the resources on the
+     * graphics queue. Must be called before any command
+     * list using the uploaded resources is submitted.
+     */
+    void flush();
+    
+  private:
+    
+    /// Number of uploads after which
+    /// uploads are submitted implicitly
+    constexpr static uint32_t MaxPendingUploads = 1024;
+    
+    DxvkDevice* m_device;
+    
+    uint32_t m_transferQueueFamily;
+    uint32_t m_graphicsQueueFamily;
+    
+    std::mutex          m_mutex;
+    Rc<DxvkCommandList> m_transferCmd;
+    Rc<DxvkCommandList> m_acquireCmd;
+    uint32_t            m_uploadCount = 0;
+    
+    std::vector<VkBufferMemoryBarrier> m_acquireBuffers;
+    std::vector<VkImageMemoryBarrier>  m_acquireImages;
+    VkPipelineStageFlags               m_acquireStages = 0;
+    
+    void beginUpload();
+    void endUpload();
+    
+    void submit();
+    
+  };
+  
+}
@@ -1,6 +1,5 @@
-#include <cstring>
-
 #include "dxvk_format.h"
+#include "dxvk_pack.h"
 #include "dxvk_util.h"
 
 namespace dxvk::util {
@@ -47,26 +46,9 @@ namespace dxvk::util {
           VkDeviceSize      pitchPerLayer) {
     const VkDeviceSize bytesPerRow   = blockCount.width  * blockSize;
     const VkDeviceSize bytesPerLayer = blockCount.height * bytesPerRow;
-    const VkDeviceSize bytesTotal    = blockCount.depth  * bytesPerLayer;
-    
-    const bool directCopy = ((bytesPerRow   == pitchPerRow  ) || (blockCount.height == 1))
-                         && ((bytesPerLayer == pitchPerLayer) || (blockCount.depth  == 1));
     
-    if (directCopy) {
-      std::memcpy(dstData, srcData, bytesTotal);
-    } else {
-      for (uint32_t i = 0; i < blockCount.depth; i++) {
-        for (uint32_t j = 0; j < blockCount.height; j++) {
-          std::memcpy(
-            dstData + j * bytesPerRow,
-            srcData + j * pitchPerRow,
-            bytesPerRow);
-        }
-        
-        srcData += pitchPerLayer;
-        dstData += bytesPerLayer;
-      }
-    }
+    copyImageData(dstData, srcData, blockCount, blockSize,
+      bytesPerRow, bytesPerLayer, pitchPerRow, pitchPerLayer);
   }
   
   
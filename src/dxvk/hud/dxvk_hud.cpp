@@ -58,6 +58,10 @@ namespace dxvk::hud {
             hud->addHudElement(new HudDeviceInfo(device));
         else if(element == "dxvk_info")
             hud->addHudElement(new HudDxvkInfo);
+        else if(element == "memory")
+            hud->addHudElement(new HudMemoryStats(device));
+        else if(element == "submissions")
+            hud->addHudElement(new HudSubmissionStats(device));
         else
             Logger::err(str::format("Unknown hud element: ", element));
     }
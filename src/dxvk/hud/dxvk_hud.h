@@ -9,6 +9,8 @@
 #include "dxvk_hud_devinfo.h"
 #include "dxvk_hud_fps.h"
 #include "dxvk_hud_dxvkinfo.h"
+#include "dxvk_hud_memory.h"
+#include "dxvk_hud_stats.h"
 #include "dxvk_hud_text.h"
 
 namespace dxvk::hud {
@@ -0,0 +1,81 @@
+#include "dxvk_hud_memory.h"
+
+namespace dxvk::hud {
+  
+  HudMemoryStats::HudMemoryStats(const Rc<DxvkDevice>& device)
+  : m_device    (device),
+    m_prevUpdate(Clock::now()) {
+    this->updateLines();
+  }
+  
+  
+  HudMemoryStats::~HudMemoryStats() {
+    
+  }
+  
+  
+  void HudMemoryStats::update() {
+    const TimePoint now = Clock::now();
+    const TimeDiff elapsed = std::chrono::duration_cast<TimeDiff>(now - m_prevUpdate);
+    
+    // Querying the stats locks all memory heaps,
+    // so we should not do this on every frame
+    if (elapsed.count() >= UpdateInterval) {
+      this->updateLines();
+      m_prevUpdate = now;
+    }
+  }
+  
+  
+  HudPos HudMemoryStats::renderText(
+    const Rc<DxvkContext>&  context,
+          HudTextRenderer&  renderer,
+          HudPos            position) {
+    for (const auto& line : m_lines) {
+      renderer.drawText(context, 16.0f,
+        { position.x, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        line);
+      
+      position.y += 20;
+    }
+    
+    return HudPos { position.x, position.y + 4 };
+  }
+  
+  
+  void HudMemoryStats::updateLines() {
+    const VkPhysicalDeviceMemoryProperties memProps
+      = m_device->adapter()->memoryProperties();
+    
+    const std::vector<DxvkMemoryStats> stats
+      = m_device->getMemoryStats();
+    
+    m_lines.clear();
+    
+    for (uint32_t i = 0; i < stats.size(); i++) {
+      if (stats[i].memoryAllocated == 0)
+        continue;
+      
+      const VkMemoryPropertyFlags flags = memProps.memoryTypes[i].propertyFlags;
+      
+      m_lines.push_back(str::format("Memory type ", i,
+        (flags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) ? " (device)" : "",
+        (flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) ? " (host)"   : "", ": ",
+        stats[i].memoryUsed      >> 20, " / ",
+        stats[i].memoryAllocated >> 20, " MB"));
+      
+      m_lines.push_back(str::format("  ",
+        stats[i].chunkCount, " chunks, ",
+        stats[i].dedicatedCount, " dedicated, ",
+        uint32_t(100.0 * stats[i].fragmentation()), "% fragmented"));
+    }
+    
+    const DxvkStatCounters counters = m_device->getStatCounters();
+    
+    m_lines.push_back(str::format("Staging: ",
+      counters.getCtr(DxvkStatCounter::StagingFrameBytes) >> 10, " kB / frame, ",
+      counters.getCtr(DxvkStatCounter::StagingRingWraps), " wraparounds"));
+  }
+  
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <chrono>
+
+#include "dxvk_hud_element.h"
+#include "dxvk_hud_text.h"
+
+namespace dxvk::hud {
+  
+  /**
+   * \brief Memory statistics display for the HUD
+   * 
+   * Displays allocation statistics for each memory
+   * type that has device memory allocated to it.
+   */
+  class HudMemoryStats : public HudElement {
+    using Clock     = std::chrono::high_resolution_clock;
+    using TimeDiff  = std::chrono::microseconds;
+    using TimePoint = typename Clock::time_point;
+    
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+    
+    HudMemoryStats(const Rc<DxvkDevice>& device);
+    virtual ~HudMemoryStats();
+    
+    void update() override;
+    
+    HudPos renderText(
+      const Rc<DxvkContext>&  context,
+            HudTextRenderer&  renderer,
+            HudPos            position) override;
+    
+  private:
+    
+    const Rc<DxvkDevice>      m_device;
+    
+    std::vector<std::string>  m_lines;
+    TimePoint                 m_prevUpdate;
+    
+    void updateLines();
+    
+  };
+  
+}
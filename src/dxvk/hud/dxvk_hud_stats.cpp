@@ -0,0 +1,70 @@
+#include "dxvk_hud_stats.h"
+
+namespace dxvk::hud {
+  
+  HudSubmissionStats::HudSubmissionStats(const Rc<DxvkDevice>& device)
+  : m_device      (device),
+    m_prevCounters(device->getStatCounters()),
+    m_prevUpdate  (Clock::now()) {
+    
+  }
+  
+  
+  HudSubmissionStats::~HudSubmissionStats() {
+    
+  }
+  
+  
+  void HudSubmissionStats::update() {
+    m_frameCount += 1;
+    
+    const TimePoint now = Clock::now();
+    const TimeDiff elapsed = std::chrono::duration_cast<TimeDiff>(now - m_prevUpdate);
+    
+    if (elapsed.count() < UpdateInterval)
+      return;
+    
+    // Only display what happened since the last update,
+    // the totals would hide changes during a long session
+    const DxvkStatCounters counters = m_device->getStatCounters();
+    
+    auto delta = [&] (DxvkStatCounter ctr) {
+      return counters.getCtr(ctr) - m_prevCounters.getCtr(ctr);
+    };
+    
+    const uint64_t submits     = delta(DxvkStatCounter::QueueSubmitCount);
+    const uint64_t descHits    = delta(DxvkStatCounter::DescSetCacheHits);
+    const uint64_t descLookups = descHits + delta(DxvkStatCounter::DescSetCacheMisses);
+    
+    m_lines.clear();
+    m_lines.push_back(str::format("Submissions: ",
+      submits / m_frameCount, " / frame"));
+    
+    if (descLookups != 0) {
+      m_lines.push_back(str::format("Descriptor sets: ",
+        (100 * descHits) / descLookups, "% reused"));
+    }
+    
+    m_prevCounters = counters;
+    m_prevUpdate   = now;
+    m_frameCount   = 0;
+  }
+  
+  
+  HudPos HudSubmissionStats::renderText(
+    const Rc<DxvkContext>&  context,
+          HudTextRenderer&  renderer,
+          HudPos            position) {
+    for (const auto& line : m_lines) {
+      renderer.drawText(context, 16.0f,
+        { position.x, position.y },
+        { 1.0f, 1.0f, 1.0f, 1.0f },
+        line);
+      
+      position.y += 20;
+    }
+    
+    return HudPos { position.x, position.y + 4 };
+  }
+  
+}
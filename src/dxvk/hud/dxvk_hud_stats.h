@@ -0,0 +1,47 @@
+#pragma once
+
+#include <chrono>
+
+#include "dxvk_hud_element.h"
+#include "dxvk_hud_text.h"
+
+namespace dxvk::hud {
+  
+  /**
+   * \brief Submission statistics display for the HUD
+   * 
+   * Displays the number of command list submissions
+   * per frame and how many descriptor sets could be
+   * reused from the descriptor set cache.
+   */
+  class HudSubmissionStats : public HudElement {
+    using Clock     = std::chrono::high_resolution_clock;
+    using TimeDiff  = std::chrono::microseconds;
+    using TimePoint = typename Clock::time_point;
+    
+    constexpr static int64_t UpdateInterval = 500'000;
+  public:
+    
+    HudSubmissionStats(const Rc<DxvkDevice>& device);
+    virtual ~HudSubmissionStats();
+    
+    void update() override;
+    
+    HudPos renderText(
+      const Rc<DxvkContext>&  context,
+            HudTextRenderer&  renderer,
+            HudPos            position) override;
+    
+  private:
+    
+    const Rc<DxvkDevice>      m_device;
+    
+    DxvkStatCounters          m_prevCounters;
+    std::vector<std::string>  m_lines;
+    
+    TimePoint                 m_prevUpdate;
+    int64_t                   m_frameCount = 0;
+    
+  };
+  
+}
@@ -1,9 +1,17 @@
 #include "dxvk_vulkan_loader.h"
+#include "dxvk_vulkan_null.h"
 
 namespace dxvk::vk {
   
+  static PFN_vkGetInstanceProcAddr getInstanceProcAddr() {
+    return isNullDeviceEnabled()
+      ? &nullGetInstanceProcAddr
+      : &::vkGetInstanceProcAddr;
+  }
+  
+  
   PFN_vkVoidFunction LibraryLoader::sym(const char* name) const {
-    return ::vkGetInstanceProcAddr(nullptr, name);
+    return getInstanceProcAddr()(nullptr, name);
   }
   
   
@@ -12,13 +20,13 @@ namespace dxvk::vk {
   
   
   PFN_vkVoidFunction InstanceLoader::sym(const char* name) const {
-    return ::vkGetInstanceProcAddr(m_instance, name);
+    return getInstanceProcAddr()(m_instance, name);
   }
   
   
   DeviceLoader::DeviceLoader(VkInstance instance, VkDevice device)
   : m_getDeviceProcAddr(reinterpret_cast<PFN_vkGetDeviceProcAddr>(
-      ::vkGetInstanceProcAddr(instance, "vkGetDeviceProcAddr"))),
+      getInstanceProcAddr()(instance, "vkGetDeviceProcAddr"))),
     m_device(device) { }
   
   
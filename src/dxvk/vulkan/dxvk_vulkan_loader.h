@@ -255,6 +255,17 @@ namespace dxvk::vk {
     VULKAN_FN(vkCmdEndRenderPass);
     VULKAN_FN(vkCmdExecuteCommands);
     
+    #ifdef VK_KHR_descriptor_update_template
+    VULKAN_FN(vkCreateDescriptorUpdateTemplateKHR);
+    VULKAN_FN(vkDestroyDescriptorUpdateTemplateKHR);
+    VULKAN_FN(vkUpdateDescriptorSetWithTemplateKHR);
+    #endif
+    
+    #ifdef VK_KHR_get_memory_requirements2
+    VULKAN_FN(vkGetBufferMemoryRequirements2KHR);
+    VULKAN_FN(vkGetImageMemoryRequirements2KHR);
+    #endif
+    
     #ifdef VK_KHR_swapchain
     VULKAN_FN(vkCreateSwapchainKHR);
     VULKAN_FN(vkDestroySwapchainKHR);
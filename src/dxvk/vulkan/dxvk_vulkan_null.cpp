@@ -0,0 +1,949 @@
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+
+#include "dxvk_vulkan_null.h"
+
+#include "../../util/util_env.h"
+
+namespace dxvk::vk {
+
+  /**
+   * \brief Fake object with backing storage
+   *
+   * Used for buffers, images and device memory, since
+   * their sizes need to be known in order to report
+   * memory requirements and to map host memory.
+   */
+  struct NullObject {
+    VkDeviceSize size  = 0;
+    VkDeviceSize pitch = 0;
+    VkFlags      usage = 0;
+    uint32_t     heap  = 0;
+    void*        data  = nullptr;
+  };
+
+
+  /**
+   * \brief Dispatchable object
+   *
+   * Loaders expect dispatchable handles to point to
+   * memory they can write to, so we hand out pointers
+   * to static instances of this struct.
+   */
+  struct NullDispatchable {
+    void* loaderData = nullptr;
+  };
+
+
+  static NullDispatchable g_nullInstance;
+  static NullDispatchable g_nullPhysicalDevice;
+  static NullDispatchable g_nullDevice;
+  static NullDispatchable g_nullQueue;
+  static NullDispatchable g_nullCommandBuffer;
+
+  static std::atomic<uint64_t> g_nullHandleId = { 1ull };
+
+  static const VkDeviceSize g_nullHeapSize = VkDeviceSize(4) << 30;
+
+  static std::atomic<VkDeviceSize> g_nullHeapUsage[2] = { { 0ull }, { 0ull } };
+
+
+  template<typename T>
+  T nullHandle(uint64_t id) {
+    if constexpr (std::is_pointer<T>::value)
+      return reinterpret_cast<T>(static_cast<uintptr_t>(id));
+    else
+      return T(id);
+  }
+
+
+  template<typename T>
+  T nullHandle() {
+    return nullHandle<T>(g_nullHandleId++);
+  }
+
+
+  template<typename T>
+  T nullObjectHandle(NullObject* object) {
+    return nullHandle<T>(reinterpret_cast<uintptr_t>(object));
+  }
+
+
+  template<typename T>
+  NullObject* nullObject(T handle) {
+    if constexpr (std::is_pointer<T>::value)
+      return reinterpret_cast<NullObject*>(handle);
+    else
+      return reinterpret_cast<NullObject*>(static_cast<uintptr_t>(handle));
+  }
+
+
+  template<typename T>
+  VkResult nullEnumerate(uint32_t* pCount, T* pOut, const T* pIn, uint32_t count) {
+    if (pOut == nullptr) {
+      *pCount = count;
+      return VK_SUCCESS;
+    }
+
+    uint32_t n = std::min(*pCount, count);
+
+    for (uint32_t i = 0; i < n; i++)
+      pOut[i] = pIn[i];
+
+    *pCount = n;
+    return n < count ? VK_INCOMPLETE : VK_SUCCESS;
+  }
+
+
+  /**
+   * \brief Default null function
+   *
+   * Does nothing and returns a value-initialized object,
+   * i.e. \c VK_SUCCESS for functions returning a result.
+   */
+  template<typename Fn>
+  struct NullFn;
+
+  template<typename Ret, typename... Args>
+  struct NullFn<Ret (VKAPI_PTR*)(Args...)> {
+    static Ret VKAPI_CALL call(Args...) {
+      return Ret();
+    }
+  };
+
+
+  namespace null {
+
+    VkResult VKAPI_CALL vkCreateInstance(
+      const VkInstanceCreateInfo*             pCreateInfo,
+      const VkAllocationCallbacks*            pAllocator,
+            VkInstance*                       pInstance) {
+      *pInstance = reinterpret_cast<VkInstance>(&g_nullInstance);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkEnumerateInstanceLayerProperties(
+            uint32_t*                         pPropertyCount,
+            VkLayerProperties*                pProperties) {
+      *pPropertyCount = 0;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkEnumerateInstanceExtensionProperties(
+      const char*                             pLayerName,
+            uint32_t*                         pPropertyCount,
+            VkExtensionProperties*            pProperties) {
+      static const VkExtensionProperties s_extensions[] = {
+        { VK_KHR_SURFACE_EXTENSION_NAME,       VK_KHR_SURFACE_SPEC_VERSION       },
+        { VK_KHR_WIN32_SURFACE_EXTENSION_NAME, VK_KHR_WIN32_SURFACE_SPEC_VERSION },
+      };
+
+      return nullEnumerate(pPropertyCount, pProperties,
+        s_extensions, sizeof(s_extensions) / sizeof(*s_extensions));
+    }
+
+
+    VkResult VKAPI_CALL vkEnumeratePhysicalDevices(
+            VkInstance                        instance,
+            uint32_t*                         pPhysicalDeviceCount,
+            VkPhysicalDevice*                 pPhysicalDevices) {
+      const VkPhysicalDevice adapter = reinterpret_cast<VkPhysicalDevice>(&g_nullPhysicalDevice);
+      return nullEnumerate(pPhysicalDeviceCount, pPhysicalDevices, &adapter, 1);
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceFeatures(
+            VkPhysicalDevice                  physicalDevice,
+            VkPhysicalDeviceFeatures*         pFeatures) {
+      VkBool32* features = reinterpret_cast<VkBool32*>(pFeatures);
+
+      for (size_t i = 0; i < sizeof(VkPhysicalDeviceFeatures) / sizeof(VkBool32); i++)
+        features[i] = VK_TRUE;
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceFormatProperties(
+            VkPhysicalDevice                  physicalDevice,
+            VkFormat                          format,
+            VkFormatProperties*               pFormatProperties) {
+      const VkFormatFeatureFlags allFeatures = 0x7FFFFFFFu;
+
+      pFormatProperties->linearTilingFeatures  = allFeatures;
+      pFormatProperties->optimalTilingFeatures = allFeatures;
+      pFormatProperties->bufferFeatures        = allFeatures;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceImageFormatProperties(
+            VkPhysicalDevice                  physicalDevice,
+            VkFormat                          format,
+            VkImageType                       type,
+            VkImageTiling                     tiling,
+            VkImageUsageFlags                 usage,
+            VkImageCreateFlags                flags,
+            VkImageFormatProperties*          pImageFormatProperties) {
+      pImageFormatProperties->maxExtent       = { 16384, 16384, 2048 };
+      pImageFormatProperties->maxMipLevels    = 15;
+      pImageFormatProperties->maxArrayLayers  = 2048;
+      pImageFormatProperties->sampleCounts    = VK_SAMPLE_COUNT_1_BIT | VK_SAMPLE_COUNT_2_BIT
+                                              | VK_SAMPLE_COUNT_4_BIT | VK_SAMPLE_COUNT_8_BIT;
+      pImageFormatProperties->maxResourceSize = VkDeviceSize(1) << 32;
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(
+            VkPhysicalDevice                  physicalDevice,
+            VkPhysicalDeviceMemoryProperties* pMemoryProperties) {
+      std::memset(pMemoryProperties, 0, sizeof(*pMemoryProperties));
+
+      pMemoryProperties->memoryTypeCount = 3;
+      pMemoryProperties->memoryTypes[0] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0 };
+      pMemoryProperties->memoryTypes[1] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                          | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 1 };
+      pMemoryProperties->memoryTypes[2] = { VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+                                          | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+                                          | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 1 };
+
+      pMemoryProperties->memoryHeapCount = 2;
+      pMemoryProperties->memoryHeaps[0] = { g_nullHeapSize, VK_MEMORY_HEAP_DEVICE_LOCAL_BIT };
+      pMemoryProperties->memoryHeaps[1] = { g_nullHeapSize, 0 };
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceProperties(
+            VkPhysicalDevice                  physicalDevice,
+            VkPhysicalDeviceProperties*       pProperties) {
+      std::memset(pProperties, 0, sizeof(*pProperties));
+
+      pProperties->apiVersion    = VK_MAKE_VERSION(1, 0, 65);
+      pProperties->driverVersion = VK_MAKE_VERSION(1, 0, 0);
+      pProperties->vendorID      = 0x10005;
+      pProperties->deviceID      = 0;
+      pProperties->deviceType    = VK_PHYSICAL_DEVICE_TYPE_CPU;
+      std::strncpy(pProperties->deviceName, "DXVK null device",
+        VK_MAX_PHYSICAL_DEVICE_NAME_SIZE);
+
+      VkPhysicalDeviceLimits& limits = pProperties->limits;
+      limits.maxImageDimension1D                = 16384;
+      limits.maxImageDimension2D                = 16384;
+      limits.maxImageDimension3D                = 2048;
+      limits.maxImageDimensionCube              = 16384;
+      limits.maxImageArrayLayers                = 2048;
+      limits.maxTexelBufferElements             = 1u << 27;
+      limits.maxUniformBufferRange              = 65536;
+      limits.maxStorageBufferRange              = 1u << 30;
+      limits.maxPushConstantsSize               = 128;
+      limits.maxMemoryAllocationCount           = 4096;
+      limits.maxSamplerAllocationCount          = 4000;
+      limits.bufferImageGranularity             = 1;
+      limits.maxBoundDescriptorSets             = 8;
+      limits.maxPerStageDescriptorSamplers      = 1u << 20;
+      limits.maxPerStageDescriptorUniformBuffers = 1u << 20;
+      limits.maxPerStageDescriptorStorageBuffers = 1u << 20;
+      limits.maxPerStageDescriptorSampledImages = 1u << 20;
+      limits.maxPerStageDescriptorStorageImages = 1u << 20;
+      limits.maxPerStageResources               = 1u << 20;
+      limits.maxDescriptorSetUniformBuffersDynamic = 8;
+      limits.maxVertexInputAttributes           = 32;
+      limits.maxVertexInputBindings             = 32;
+      limits.maxVertexInputBindingStride        = 2048;
+      limits.maxColorAttachments                = 8;
+      limits.maxViewports                       = 16;
+      limits.maxViewportDimensions[0]           = 16384;
+      limits.maxViewportDimensions[1]           = 16384;
+      limits.maxFramebufferWidth                = 16384;
+      limits.maxFramebufferHeight               = 16384;
+      limits.maxFramebufferLayers               = 2048;
+      limits.minMemoryMapAlignment              = 64;
+      limits.minTexelBufferOffsetAlignment      = 16;
+      limits.minUniformBufferOffsetAlignment    = 256;
+      limits.minStorageBufferOffsetAlignment    = 16;
+      limits.nonCoherentAtomSize                = 64;
+      limits.optimalBufferCopyOffsetAlignment   = 1;
+      limits.optimalBufferCopyRowPitchAlignment = 1;
+      limits.timestampPeriod                    = 1.0f;
+    }
+
+
+    void VKAPI_CALL vkGetPhysicalDeviceQueueFamilyProperties(
+            VkPhysicalDevice                  physicalDevice,
+            uint32_t*                         pQueueFamilyPropertyCount,
+            VkQueueFamilyProperties*          pQueueFamilyProperties) {
+      // Expose a dedicated transfer queue family as
+      // well, like most discrete GPUs do nowadays
+      std::array<VkQueueFamilyProperties, 2> families;
+      families[0].queueFlags                  = VK_QUEUE_GRAPHICS_BIT
+                                              | VK_QUEUE_COMPUTE_BIT
+                                              | VK_QUEUE_TRANSFER_BIT;
+      families[0].queueCount                  = 1;
+      families[0].timestampValidBits          = 64;
+      families[0].minImageTransferGranularity = { 1, 1, 1 };
+
+      families[1].queueFlags                  = VK_QUEUE_TRANSFER_BIT;
+      families[1].queueCount                  = 1;
+      families[1].timestampValidBits          = 64;
+      families[1].minImageTransferGranularity = { 1, 1, 1 };
+
+      nullEnumerate(pQueueFamilyPropertyCount, pQueueFamilyProperties,
+        families.data(), families.size());
+    }
+
+
+    VkResult VKAPI_CALL vkEnumerateDeviceExtensionProperties(
+            VkPhysicalDevice                  physicalDevice,
+      const char*                             pLayerName,
+            uint32_t*                         pPropertyCount,
+            VkExtensionProperties*            pProperties) {
+      static const VkExtensionProperties s_extensions[] = {
+        { VK_KHR_DEDICATED_ALLOCATION_EXTENSION_NAME,       VK_KHR_DEDICATED_ALLOCATION_SPEC_VERSION       },
+        { VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_EXTENSION_NAME, VK_KHR_DESCRIPTOR_UPDATE_TEMPLATE_SPEC_VERSION },
+        { VK_KHR_GET_MEMORY_REQUIREMENTS_2_EXTENSION_NAME,  VK_KHR_GET_MEMORY_REQUIREMENTS_2_SPEC_VERSION  },
+        { VK_KHR_MAINTENANCE1_EXTENSION_NAME,               VK_KHR_MAINTENANCE1_SPEC_VERSION               },
+        { VK_KHR_MAINTENANCE2_EXTENSION_NAME,               VK_KHR_MAINTENANCE2_SPEC_VERSION               },
+        { VK_KHR_SHADER_DRAW_PARAMETERS_EXTENSION_NAME,     VK_KHR_SHADER_DRAW_PARAMETERS_SPEC_VERSION     },
+        { VK_KHR_SWAPCHAIN_EXTENSION_NAME,                  VK_KHR_SWAPCHAIN_SPEC_VERSION                  },
+      };
+
+      return nullEnumerate(pPropertyCount, pProperties,
+        s_extensions, sizeof(s_extensions) / sizeof(*s_extensions));
+    }
+
+
+    VkResult VKAPI_CALL vkCreateDevice(
+            VkPhysicalDevice                  physicalDevice,
+      const VkDeviceCreateInfo*               pCreateInfo,
+      const VkAllocationCallbacks*            pAllocator,
+            VkDevice*                         pDevice) {
+      *pDevice = reinterpret_cast<VkDevice>(&g_nullDevice);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateWin32SurfaceKHR(
+            VkInstance                        instance,
+      const VkWin32SurfaceCreateInfoKHR*      pCreateInfo,
+      const VkAllocationCallbacks*            pAllocator,
+            VkSurfaceKHR*                     pSurface) {
+      *pSurface = nullHandle<VkSurfaceKHR>();
+      return VK_SUCCESS;
+    }
+
+
+    VkBool32 VKAPI_CALL vkGetPhysicalDeviceWin32PresentationSupportKHR(
+            VkPhysicalDevice                  physicalDevice,
+            uint32_t                          queueFamilyIndex) {
+      return VK_TRUE;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceSupportKHR(
+            VkPhysicalDevice                  physicalDevice,
+            uint32_t                          queueFamilyIndex,
+            VkSurfaceKHR                      surface,
+            VkBool32*                         pSupported) {
+      *pSupported = VK_TRUE;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+            VkPhysicalDevice                  physicalDevice,
+            VkSurfaceKHR                      surface,
+            VkSurfaceCapabilitiesKHR*         pSurfaceCapabilities) {
+      pSurfaceCapabilities->minImageCount           = 2;
+      pSurfaceCapabilities->maxImageCount           = 8;
+      pSurfaceCapabilities->currentExtent           = { 0xFFFFFFFFu, 0xFFFFFFFFu };
+      pSurfaceCapabilities->minImageExtent          = { 1, 1 };
+      pSurfaceCapabilities->maxImageExtent          = { 16384, 16384 };
+      pSurfaceCapabilities->maxImageArrayLayers     = 1;
+      pSurfaceCapabilities->supportedTransforms     = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+      pSurfaceCapabilities->currentTransform        = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+      pSurfaceCapabilities->supportedCompositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+      pSurfaceCapabilities->supportedUsageFlags     = VK_IMAGE_USAGE_TRANSFER_DST_BIT
+                                                    | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfaceFormatsKHR(
+            VkPhysicalDevice                  physicalDevice,
+            VkSurfaceKHR                      surface,
+            uint32_t*                         pSurfaceFormatCount,
+            VkSurfaceFormatKHR*               pSurfaceFormats) {
+      static const VkSurfaceFormatKHR s_formats[] = {
+        { VK_FORMAT_B8G8R8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_B8G8R8A8_SRGB,  VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_R8G8B8A8_UNORM, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+        { VK_FORMAT_R8G8B8A8_SRGB,  VK_COLOR_SPACE_SRGB_NONLINEAR_KHR },
+      };
+
+      return nullEnumerate(pSurfaceFormatCount, pSurfaceFormats,
+        s_formats, sizeof(s_formats) / sizeof(*s_formats));
+    }
+
+
+    VkResult VKAPI_CALL vkGetPhysicalDeviceSurfacePresentModesKHR(
+            VkPhysicalDevice                  physicalDevice,
+            VkSurfaceKHR                      surface,
+            uint32_t*                         pPresentModeCount,
+            VkPresentModeKHR*                 pPresentModes) {
+      static const VkPresentModeKHR s_modes[] = {
+        VK_PRESENT_MODE_IMMEDIATE_KHR,
+        VK_PRESENT_MODE_MAILBOX_KHR,
+        VK_PRESENT_MODE_FIFO_KHR,
+      };
+
+      return nullEnumerate(pPresentModeCount, pPresentModes,
+        s_modes, sizeof(s_modes) / sizeof(*s_modes));
+    }
+
+
+    void VKAPI_CALL vkGetDeviceQueue(
+            VkDevice                          device,
+            uint32_t                          queueFamilyIndex,
+            uint32_t                          queueIndex,
+            VkQueue*                          pQueue) {
+      *pQueue = reinterpret_cast<VkQueue>(&g_nullQueue);
+    }
+
+
+    VkResult VKAPI_CALL vkAllocateMemory(
+            VkDevice                          device,
+      const VkMemoryAllocateInfo*             pAllocateInfo,
+      const VkAllocationCallbacks*            pAllocator,
+            VkDeviceMemory*                   pMemory) {
+      // Fail allocations beyond the heap size like a real
+      // driver would, so that out-of-memory handling can
+      // be tested without exhausting actual memory.
+      const uint32_t     heap = pAllocateInfo->memoryTypeIndex != 0 ? 1 : 0;
+      const VkDeviceSize size = pAllocateInfo->allocationSize;
+
+      if (g_nullHeapUsage[heap].fetch_add(size) + size > g_nullHeapSize) {
+        g_nullHeapUsage[heap] -= size;
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+      }
+
+      NullObject* memory = new NullObject();
+      memory->size = size;
+      memory->heap = heap;
+
+      // Only host-visible memory types need actual storage
+      if (heap != 0) {
+        memory->data = std::calloc(1, size_t(memory->size));
+
+        if (memory->data == nullptr) {
+          g_nullHeapUsage[heap] -= size;
+          delete memory;
+          return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+      }
+
+      *pMemory = nullObjectHandle<VkDeviceMemory>(memory);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkFreeMemory(
+            VkDevice                          device,
+            VkDeviceMemory                    memory,
+      const VkAllocationCallbacks*            pAllocator) {
+      if (memory != VK_NULL_HANDLE) {
+        NullObject* object = nullObject(memory);
+        g_nullHeapUsage[object->heap] -= object->size;
+        std::free(object->data);
+        delete object;
+      }
+    }
+
+
+    VkResult VKAPI_CALL vkMapMemory(
+            VkDevice                          device,
+            VkDeviceMemory                    memory,
+            VkDeviceSize                      offset,
+            VkDeviceSize                      size,
+            VkMemoryMapFlags                  flags,
+            void**                            ppData) {
+      NullObject* object = nullObject(memory);
+
+      if (object->data == nullptr)
+        return VK_ERROR_MEMORY_MAP_FAILED;
+
+      *ppData = reinterpret_cast<char*>(object->data) + offset;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateBuffer(
+            VkDevice                          device,
+      const VkBufferCreateInfo*               pCreateInfo,
+      const VkAllocationCallbacks*            pAllocator,
+            VkBuffer*                         pBuffer) {
+      NullObject* buffer = new NullObject();
+      buffer->size = pCreateInfo->size;
+
+      *pBuffer = nullObjectHandle<VkBuffer>(buffer);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyBuffer(
+            VkDevice                          device,
+            VkBuffer                          buffer,
+      const VkAllocationCallbacks*            pAllocator) {
+      if (buffer != VK_NULL_HANDLE)
+        delete nullObject(buffer);
+    }
+
+
+    void VKAPI_CALL vkGetBufferMemoryRequirements(
+            VkDevice                          device,
+            VkBuffer                          buffer,
+            VkMemoryRequirements*             pMemoryRequirements) {
+      pMemoryRequirements->size           = (nullObject(buffer)->size + 255) & ~VkDeviceSize(255);
+      pMemoryRequirements->alignment      = 256;
+      pMemoryRequirements->memoryTypeBits = 0x7;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateImage(
+            VkDevice                          device,
+      const VkImageCreateInfo*                pCreateInfo,
+      const VkAllocationCallbacks*            pAllocator,
+            VkImage*                          pImage) {
+      // We don't know the format's texel size here, so use
+      // an upper bound of 16 bytes per texel and per sample.
+      VkExtent3D   extent = pCreateInfo->extent;
+      VkDeviceSize size   = 0;
+
+      for (uint32_t i = 0; i < pCreateInfo->mipLevels; i++) {
+        size += VkDeviceSize(extent.width) * extent.height * extent.depth;
+
+        extent.width  = std::max(extent.width  / 2, 1u);
+        extent.height = std::max(extent.height / 2, 1u);
+        extent.depth  = std::max(extent.depth  / 2, 1u);
+      }
+
+      NullObject* image = new NullObject();
+      image->size  = size * 16 * pCreateInfo->arrayLayers * pCreateInfo->samples;
+      image->pitch = VkDeviceSize(pCreateInfo->extent.width) * 16;
+      image->usage = pCreateInfo->usage;
+
+      *pImage = nullObjectHandle<VkImage>(image);
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkDestroyImage(
+            VkDevice                          device,
+            VkImage                           image,
+      const VkAllocationCallbacks*            pAllocator) {
+      if (image != VK_NULL_HANDLE)
+        delete nullObject(image);
+    }
+
+
+    void VKAPI_CALL vkGetImageMemoryRequirements(
+            VkDevice                          device,
+            VkImage                           image,
+            VkMemoryRequirements*             pMemoryRequirements) {
+      pMemoryRequirements->size           = (nullObject(image)->size + 255) & ~VkDeviceSize(255);
+      pMemoryRequirements->alignment      = 256;
+      pMemoryRequirements->memoryTypeBits = 0x7;
+    }
+
+
+    void setDedicatedRequirements(
+            void*                             pNext,
+            VkBool32                          prefersDedicated) {
+      auto req = reinterpret_cast<VkMemoryDedicatedRequirementsKHR*>(pNext);
+
+      while (req != nullptr && req->sType != VK_STRUCTURE_TYPE_MEMORY_DEDICATED_REQUIREMENTS_KHR)
+        req = reinterpret_cast<VkMemoryDedicatedRequirementsKHR*>(req->pNext);
+
+      if (req != nullptr) {
+        req->prefersDedicatedAllocation  = prefersDedicated;
+        req->requiresDedicatedAllocation = VK_FALSE;
+      }
+    }
+
+
+    void VKAPI_CALL vkGetBufferMemoryRequirements2KHR(
+            VkDevice                          device,
+      const VkBufferMemoryRequirementsInfo2KHR* pInfo,
+            VkMemoryRequirements2KHR*         pMemoryRequirements) {
+      null::vkGetBufferMemoryRequirements(device, pInfo->buffer,
+        &pMemoryRequirements->memoryRequirements);
+      setDedicatedRequirements(pMemoryRequirements->pNext, VK_FALSE);
+    }
+
+
+    void VKAPI_CALL vkGetImageMemoryRequirements2KHR(
+            VkDevice                          device,
+      const VkImageMemoryRequirementsInfo2KHR* pInfo,
+            VkMemoryRequirements2KHR*         pMemoryRequirements) {
+      null::vkGetImageMemoryRequirements(device, pInfo->image,
+        &pMemoryRequirements->memoryRequirements);
+
+      // Mimic drivers which prefer render targets
+      // to be placed in dedicated allocations
+      const VkImageUsageFlags attachmentUsage
+        = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+        | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+
+      setDedicatedRequirements(pMemoryRequirements->pNext,
+        (nullObject(pInfo->image)->usage & attachmentUsage) ? VK_TRUE : VK_FALSE);
+    }
+
+
+    void VKAPI_CALL vkGetImageSubresourceLayout(
+            VkDevice                          device,
+            VkImage                           image,
+      const VkImageSubresource*               pSubresource,
+            VkSubresourceLayout*              pLayout) {
+      const NullObject* object = nullObject(image);
+
+      pLayout->offset     = 0;
+      pLayout->size       = object->size;
+      pLayout->rowPitch   = object->pitch;
+      pLayout->arrayPitch = object->size;
+      pLayout->depthPitch = object->size;
+    }
+
+
+    VkResult VKAPI_CALL vkGetEventStatus(
+            VkDevice                          device,
+            VkEvent                           event) {
+      return VK_EVENT_SET;
+    }
+
+
+    VkResult VKAPI_CALL vkGetQueryPoolResults(
+            VkDevice                          device,
+            VkQueryPool                       queryPool,
+            uint32_t                          firstQuery,
+            uint32_t                          queryCount,
+            size_t                            dataSize,
+            void*                             pData,
+            VkDeviceSize                      stride,
+            VkQueryResultFlags                flags) {
+      std::memset(pData, 0, dataSize);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetPipelineCacheData(
+            VkDevice                          device,
+            VkPipelineCache                   pipelineCache,
+            size_t*                           pDataSize,
+            void*                             pData) {
+      *pDataSize = 0;
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateGraphicsPipelines(
+            VkDevice                          device,
+            VkPipelineCache                   pipelineCache,
+            uint32_t                          createInfoCount,
+      const VkGraphicsPipelineCreateInfo*     pCreateInfos,
+      const VkAllocationCallbacks*            pAllocator,
+            VkPipeline*                       pPipelines) {
+      for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = nullHandle<VkPipeline>();
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkCreateComputePipelines(
+            VkDevice                          device,
+            VkPipelineCache                   pipelineCache,
+            uint32_t                          createInfoCount,
+      const VkComputePipelineCreateInfo*      pCreateInfos,
+      const VkAllocationCallbacks*            pAllocator,
+            VkPipeline*                       pPipelines) {
+      for (uint32_t i = 0; i < createInfoCount; i++)
+        pPipelines[i] = nullHandle<VkPipeline>();
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkAllocateDescriptorSets(
+            VkDevice                          device,
+      const VkDescriptorSetAllocateInfo*      pAllocateInfo,
+            VkDescriptorSet*                  pDescriptorSets) {
+      for (uint32_t i = 0; i < pAllocateInfo->descriptorSetCount; i++)
+        pDescriptorSets[i] = nullHandle<VkDescriptorSet>();
+      return VK_SUCCESS;
+    }
+
+
+    void VKAPI_CALL vkGetRenderAreaGranularity(
+            VkDevice                          device,
+            VkRenderPass                      renderPass,
+            VkExtent2D*                       pGranularity) {
+      *pGranularity = { 1, 1 };
+    }
+
+
+    VkResult VKAPI_CALL vkAllocateCommandBuffers(
+            VkDevice                          device,
+      const VkCommandBufferAllocateInfo*      pAllocateInfo,
+            VkCommandBuffer*                  pCommandBuffers) {
+      for (uint32_t i = 0; i < pAllocateInfo->commandBufferCount; i++)
+        pCommandBuffers[i] = reinterpret_cast<VkCommandBuffer>(&g_nullCommandBuffer);
+      return VK_SUCCESS;
+    }
+
+
+    VkResult VKAPI_CALL vkGetSwapchainImagesKHR(
+            VkDevice                          device,
+            VkSwapchainKHR                    swapchain,
+            uint32_t*                         pSwapchainImageCount,
+            VkImage*                          pSwapchainImages) {
+      // Swap chain images are never destroyed by the
+      // application, so use plain handles for them.
+      const VkImage images[2] = {
+        nullHandle<VkImage>(), nullHandle<VkImage>() };
+
+      return nullEnumerate(pSwapchainImageCount, pSwapchainImages, images, 2);
+    }
+
+
+    VkResult VKAPI_CALL vkAcquireNextImageKHR(
+            VkDevice                          device,
+            VkSwapchainKHR                    swapchain,
+            uint64_t                          timeout,
+            VkSemaphore                       semaphore,
+            VkFence                           fence,
+            uint32_t*                         pImageIndex) {
+      static std::atomic<uint32_t> s_imageIndex = { 0u };
+      *pImageIndex = (s_imageIndex++) & 1;
+      return VK_SUCCESS;
+    }
+
+  }
+
+
+  #define NULL_FN_DEFAULT(name) \
+    { #name, reinterpret_cast<PFN_vkVoidFunction>(&NullFn<PFN_ ## name>::call) }
+
+  #define NULL_FN_CREATE(name, type) \
+    { #name, reinterpret_cast<PFN_vkVoidFunction>(&NullCreateFn<PFN_ ## name, type>::call) }
+
+  #define NULL_FN_IMPL(name) \
+    { #name, reinterpret_cast<PFN_vkVoidFunction>(&null::name) }
+
+
+  /**
+   * \brief Null object creation function
+   *
+   * Implements the common \c vkCreate* signature by
+   * writing a unique fake handle to the last argument.
+   */
+  template<typename Fn, typename T>
+  struct NullCreateFn;
+
+  template<typename Info, typename T>
+  struct NullCreateFn<VkResult (VKAPI_PTR*)(VkDevice, const Info*, const VkAllocationCallbacks*, T*), T> {
+    static VkResult VKAPI_CALL call(VkDevice, const Info*, const VkAllocationCallbacks*, T* pObject) {
+      *pObject = nullHandle<T>();
+      return VK_SUCCESS;
+    }
+  };
+
+
+  VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL nullGetDeviceProcAddr(
+          VkDevice            device,
+    const char*               name) {
+    static const std::unordered_map<std::string, PFN_vkVoidFunction> s_functions = {
+      NULL_FN_IMPL   (vkGetDeviceQueue),
+      NULL_FN_DEFAULT(vkDestroyDevice),
+      NULL_FN_DEFAULT(vkQueueSubmit),
+      NULL_FN_DEFAULT(vkQueueWaitIdle),
+      NULL_FN_DEFAULT(vkDeviceWaitIdle),
+      NULL_FN_IMPL   (vkAllocateMemory),
+      NULL_FN_IMPL   (vkFreeMemory),
+      NULL_FN_IMPL   (vkMapMemory),
+      NULL_FN_DEFAULT(vkUnmapMemory),
+      NULL_FN_DEFAULT(vkFlushMappedMemoryRanges),
+      NULL_FN_DEFAULT(vkInvalidateMappedMemoryRanges),
+      NULL_FN_DEFAULT(vkGetDeviceMemoryCommitment),
+      NULL_FN_DEFAULT(vkBindBufferMemory),
+      NULL_FN_DEFAULT(vkBindImageMemory),
+      NULL_FN_IMPL   (vkGetBufferMemoryRequirements),
+      NULL_FN_IMPL   (vkGetImageMemoryRequirements),
+      NULL_FN_IMPL   (vkGetBufferMemoryRequirements2KHR),
+      NULL_FN_IMPL   (vkGetImageMemoryRequirements2KHR),
+      NULL_FN_DEFAULT(vkGetImageSparseMemoryRequirements),
+      NULL_FN_DEFAULT(vkQueueBindSparse),
+      NULL_FN_CREATE (vkCreateFence, VkFence),
+      NULL_FN_DEFAULT(vkDestroyFence),
+      NULL_FN_DEFAULT(vkResetFences),
+      NULL_FN_DEFAULT(vkGetFenceStatus),
+      NULL_FN_DEFAULT(vkWaitForFences),
+      NULL_FN_CREATE (vkCreateSemaphore, VkSemaphore),
+      NULL_FN_DEFAULT(vkDestroySemaphore),
+      NULL_FN_CREATE (vkCreateEvent, VkEvent),
+      NULL_FN_DEFAULT(vkDestroyEvent),
+      NULL_FN_IMPL   (vkGetEventStatus),
+      NULL_FN_DEFAULT(vkSetEvent),
+      NULL_FN_DEFAULT(vkResetEvent),
+      NULL_FN_CREATE (vkCreateQueryPool, VkQueryPool),
+      NULL_FN_DEFAULT(vkDestroyQueryPool),
+      NULL_FN_IMPL   (vkGetQueryPoolResults),
+      NULL_FN_IMPL   (vkCreateBuffer),
+      NULL_FN_IMPL   (vkDestroyBuffer),
+      NULL_FN_CREATE (vkCreateBufferView, VkBufferView),
+      NULL_FN_DEFAULT(vkDestroyBufferView),
+      NULL_FN_IMPL   (vkCreateImage),
+      NULL_FN_IMPL   (vkDestroyImage),
+      NULL_FN_IMPL   (vkGetImageSubresourceLayout),
+      NULL_FN_CREATE (vkCreateImageView, VkImageView),
+      NULL_FN_DEFAULT(vkDestroyImageView),
+      NULL_FN_CREATE (vkCreateShaderModule, VkShaderModule),
+      NULL_FN_DEFAULT(vkDestroyShaderModule),
+      NULL_FN_CREATE (vkCreatePipelineCache, VkPipelineCache),
+      NULL_FN_DEFAULT(vkDestroyPipelineCache),
+      NULL_FN_IMPL   (vkGetPipelineCacheData),
+      NULL_FN_DEFAULT(vkMergePipelineCaches),
+      NULL_FN_IMPL   (vkCreateGraphicsPipelines),
+      NULL_FN_IMPL   (vkCreateComputePipelines),
+      NULL_FN_DEFAULT(vkDestroyPipeline),
+      NULL_FN_CREATE (vkCreatePipelineLayout, VkPipelineLayout),
+      NULL_FN_DEFAULT(vkDestroyPipelineLayout),
+      NULL_FN_CREATE (vkCreateSampler, VkSampler),
+      NULL_FN_DEFAULT(vkDestroySampler),
+      NULL_FN_CREATE (vkCreateDescriptorSetLayout, VkDescriptorSetLayout),
+      NULL_FN_DEFAULT(vkDestroyDescriptorSetLayout),
+      NULL_FN_CREATE (vkCreateDescriptorPool, VkDescriptorPool),
+      NULL_FN_DEFAULT(vkDestroyDescriptorPool),
+      NULL_FN_DEFAULT(vkResetDescriptorPool),
+      NULL_FN_IMPL   (vkAllocateDescriptorSets),
+      NULL_FN_DEFAULT(vkFreeDescriptorSets),
+      NULL_FN_DEFAULT(vkUpdateDescriptorSets),
+      NULL_FN_CREATE (vkCreateDescriptorUpdateTemplateKHR, VkDescriptorUpdateTemplateKHR),
+      NULL_FN_DEFAULT(vkDestroyDescriptorUpdateTemplateKHR),
+      NULL_FN_DEFAULT(vkUpdateDescriptorSetWithTemplateKHR),
+      NULL_FN_CREATE (vkCreateFramebuffer, VkFramebuffer),
+      NULL_FN_DEFAULT(vkDestroyFramebuffer),
+      NULL_FN_CREATE (vkCreateRenderPass, VkRenderPass),
+      NULL_FN_DEFAULT(vkDestroyRenderPass),
+      NULL_FN_IMPL   (vkGetRenderAreaGranularity),
+      NULL_FN_CREATE (vkCreateCommandPool, VkCommandPool),
+      NULL_FN_DEFAULT(vkDestroyCommandPool),
+      NULL_FN_DEFAULT(vkResetCommandPool),
+      NULL_FN_IMPL   (vkAllocateCommandBuffers),
+      NULL_FN_DEFAULT(vkFreeCommandBuffers),
+      NULL_FN_DEFAULT(vkBeginCommandBuffer),
+      NULL_FN_DEFAULT(vkEndCommandBuffer),
+      NULL_FN_DEFAULT(vkResetCommandBuffer),
+      NULL_FN_DEFAULT(vkCmdBindPipeline),
+      NULL_FN_DEFAULT(vkCmdSetViewport),
+      NULL_FN_DEFAULT(vkCmdSetScissor),
+      NULL_FN_DEFAULT(vkCmdSetLineWidth),
+      NULL_FN_DEFAULT(vkCmdSetDepthBias),
+      NULL_FN_DEFAULT(vkCmdSetBlendConstants),
+      NULL_FN_DEFAULT(vkCmdSetDepthBounds),
+      NULL_FN_DEFAULT(vkCmdSetStencilCompareMask),
+      NULL_FN_DEFAULT(vkCmdSetStencilWriteMask),
+      NULL_FN_DEFAULT(vkCmdSetStencilReference),
+      NULL_FN_DEFAULT(vkCmdBindDescriptorSets),
+      NULL_FN_DEFAULT(vkCmdBindIndexBuffer),
+      NULL_FN_DEFAULT(vkCmdBindVertexBuffers),
+      NULL_FN_DEFAULT(vkCmdDraw),
+      NULL_FN_DEFAULT(vkCmdDrawIndexed),
+      NULL_FN_DEFAULT(vkCmdDrawIndirect),
+      NULL_FN_DEFAULT(vkCmdDrawIndexedIndirect),
+      NULL_FN_DEFAULT(vkCmdDispatch),
+      NULL_FN_DEFAULT(vkCmdDispatchIndirect),
+      NULL_FN_DEFAULT(vkCmdCopyBuffer),
+      NULL_FN_DEFAULT(vkCmdCopyImage),
+      NULL_FN_DEFAULT(vkCmdBlitImage),
+      NULL_FN_DEFAULT(vkCmdCopyBufferToImage),
+      NULL_FN_DEFAULT(vkCmdCopyImageToBuffer),
+      NULL_FN_DEFAULT(vkCmdUpdateBuffer),
+      NULL_FN_DEFAULT(vkCmdFillBuffer),
+      NULL_FN_DEFAULT(vkCmdClearColorImage),
+      NULL_FN_DEFAULT(vkCmdClearDepthStencilImage),
+      NULL_FN_DEFAULT(vkCmdClearAttachments),
+      NULL_FN_DEFAULT(vkCmdResolveImage),
+      NULL_FN_DEFAULT(vkCmdSetEvent),
+      NULL_FN_DEFAULT(vkCmdResetEvent),
+      NULL_FN_DEFAULT(vkCmdWaitEvents),
+      NULL_FN_DEFAULT(vkCmdPipelineBarrier),
+      NULL_FN_DEFAULT(vkCmdBeginQuery),
+      NULL_FN_DEFAULT(vkCmdEndQuery),
+      NULL_FN_DEFAULT(vkCmdResetQueryPool),
+      NULL_FN_DEFAULT(vkCmdWriteTimestamp),
+      NULL_FN_DEFAULT(vkCmdCopyQueryPoolResults),
+      NULL_FN_DEFAULT(vkCmdPushConstants),
+      NULL_FN_DEFAULT(vkCmdBeginRenderPass),
+      NULL_FN_DEFAULT(vkCmdNextSubpass),
+      NULL_FN_DEFAULT(vkCmdEndRenderPass),
+      NULL_FN_DEFAULT(vkCmdExecuteCommands),
+      NULL_FN_CREATE (vkCreateSwapchainKHR, VkSwapchainKHR),
+      NULL_FN_DEFAULT(vkDestroySwapchainKHR),
+      NULL_FN_IMPL   (vkGetSwapchainImagesKHR),
+      NULL_FN_IMPL   (vkAcquireNextImageKHR),
+      NULL_FN_DEFAULT(vkQueuePresentKHR),
+    };
+
+    auto entry = s_functions.find(name);
+
+    if (entry == s_functions.end())
+      return nullptr;
+
+    return entry->second;
+  }
+
+
+  VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL nullGetInstanceProcAddr(
+          VkInstance          instance,
+    const char*               name) {
+    static const std::unordered_map<std::string, PFN_vkVoidFunction> s_functions = {
+      NULL_FN_IMPL   (vkCreateInstance),
+      NULL_FN_IMPL   (vkEnumerateInstanceLayerProperties),
+      NULL_FN_IMPL   (vkEnumerateInstanceExtensionProperties),
+      NULL_FN_DEFAULT(vkDestroyInstance),
+      NULL_FN_IMPL   (vkCreateDevice),
+      NULL_FN_IMPL   (vkEnumerateDeviceExtensionProperties),
+      NULL_FN_IMPL   (vkEnumeratePhysicalDevices),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceFeatures),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceFormatProperties),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceImageFormatProperties),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceMemoryProperties),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceProperties),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceQueueFamilyProperties),
+      NULL_FN_DEFAULT(vkGetPhysicalDeviceSparseImageFormatProperties),
+      NULL_FN_IMPL   (vkCreateWin32SurfaceKHR),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceWin32PresentationSupportKHR),
+      NULL_FN_DEFAULT(vkDestroySurfaceKHR),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceSurfaceSupportKHR),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceSurfaceCapabilitiesKHR),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceSurfaceFormatsKHR),
+      NULL_FN_IMPL   (vkGetPhysicalDeviceSurfacePresentModesKHR),
+      { "vkGetDeviceProcAddr", reinterpret_cast<PFN_vkVoidFunction>(&nullGetDeviceProcAddr) },
+    };
+
+    auto entry = s_functions.find(name);
+
+    if (entry == s_functions.end())
+      return nullGetDeviceProcAddr(VK_NULL_HANDLE, name);
+
+    return entry->second;
+  }
+
+
+  bool isNullDeviceEnabled() {
+    static const bool s_enabled = env::getEnvVar(L"DXVK_NULL_DEVICE") == "1";
+    return s_enabled;
+  }
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "dxvk_vulkan_loader_fn.h"
+
+namespace dxvk::vk {
+
+  /**
+   * \brief Checks whether the null device is enabled
+   *
+   * The null device is enabled by setting the
+   * \c DXVK_NULL_DEVICE environment variable to
+   * \c 1. The setting is read once per process.
+   * \returns \c true if the null device is used
+   */
+  bool isNullDeviceEnabled();
+
+  /**
+   * \brief Null implementation of vkGetInstanceProcAddr
+   *
+   * Returns functions of a fake Vulkan implementation which
+   * exposes a single physical device. Device functions accept
+   * all \c vkCmd* calls as no-ops and create fake objects, so
+   * that the CPU-side cost of DXVK can be measured on systems
+   * without a usable GPU. Nothing is ever rendered.
+   * \param [in] instance Instance handle, ignored
+   * \param [in] name Function name
+   * \returns Function pointer, or \c nullptr
+   */
+  VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL nullGetInstanceProcAddr(
+          VkInstance          instance,
+    const char*               name);
+
+  /**
+   * \brief Null implementation of vkGetDeviceProcAddr
+   *
+   * \param [in] device Device handle, ignored
+   * \param [in] name Function name
+   * \returns Function pointer, or \c nullptr
+   */
+  VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL nullGetDeviceProcAddr(
+          VkDevice            device,
+    const char*               name);
+
+}
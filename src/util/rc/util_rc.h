@@ -19,6 +19,39 @@ namespace dxvk {
       return ++m_refCount;
     }
     
+    /**
+     * \brief Increments reference count of a live object
+     * 
+     * Fails if the reference count is zero, which means
+     * that the object is being destroyed. Allows taking
+     * a reference to an object through a non-owning
+     * pointer, as long as the destructor removes that
+     * pointer under a lock that the caller also holds.
+     * \returns \c true if a reference was acquired
+     */
+    bool tryIncRef() {
+      uint32_t refCount = m_refCount.load();
+      
+      do {
+        if (refCount == 0)
+          return false;
+      } while (!m_refCount.compare_exchange_weak(refCount, refCount + 1));
+      
+      return true;
+    }
+    
+    /**
+     * \brief Current reference count
+     * 
+     * The value is only meaningful if the caller
+     * knows that no other thread can create new
+     * references to the object concurrently.
+     * \returns Reference count
+     */
+    uint32_t refCount() const {
+      return m_refCount.load();
+    }
+    
     /**
      * \brief Decrements reference count
      * \returns New reference count
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace dxvk::bit {
   
   template<typename T>
@@ -23,4 +29,48 @@ namespace dxvk::bit {
     return result;
   }
   
+  /**
+   * \brief Index of the lowest set bit
+   * 
+   * \param [in] value Value, must not be zero
+   * \returns Bit index of the lowest set bit
+   */
+  inline uint32_t bsf(uint64_t value) {
+    #if defined(_MSC_VER) && defined(_M_IX86)
+    unsigned long index;
+    if (_BitScanForward(&index, uint32_t(value)))
+      return uint32_t(index);
+    _BitScanForward(&index, uint32_t(value >> 32));
+    return uint32_t(index) + 32;
+    #elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return uint32_t(index);
+    #else
+    return uint32_t(__builtin_ctzll(value));
+    #endif
+  }
+  
+  /**
+   * \brief Index of the highest set bit
+   * 
+   * \param [in] value Value, must not be zero
+   * \returns Bit index of the highest set bit
+   */
+  inline uint32_t bsr(uint64_t value) {
+    #if defined(_MSC_VER) && defined(_M_IX86)
+    unsigned long index;
+    if (_BitScanReverse(&index, uint32_t(value >> 32)))
+      return uint32_t(index) + 32;
+    _BitScanReverse(&index, uint32_t(value));
+    return uint32_t(index);
+    #elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return uint32_t(index);
+    #else
+    return uint32_t(63 - __builtin_clzll(value));
+    #endif
+  }
+  
 }
\ No newline at end of file
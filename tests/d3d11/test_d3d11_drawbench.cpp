@@ -0,0 +1,205 @@
+#include <array>
+#include <chrono>
+#include <cstring>
+
+#include <d3dcompiler.h>
+#include <d3d11.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+#include "../test_utils.h"
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+const std::string g_vertexShaderCode =
+  "cbuffer cb : register(b0) {\n"
+  "  float4 offset;\n"
+  "};\n"
+  "float4 main(uint vid : SV_VERTEXID) : SV_POSITION {\n"
+  "  float2 pos = float2(vid & 1, vid >> 1);\n"
+  "  return float4(pos, 0.0f, 1.0f) + offset;\n"
+  "}\n";
+  
+const std::string g_pixelShaderCode =
+  "Texture2D<float4> tex : register(t0);\n"
+  "SamplerState smp : register(s0);\n"
+  "float4 main(float4 pos : SV_POSITION) : SV_TARGET {\n"
+  "  return tex.Sample(smp, pos.xy);\n"
+  "}\n";
+  
+// Runs a large number of small draws with typical per-draw
+// state changes (constant buffer discard, texture binding)
+// and reports the cost of each stage of the D3D11 front-end.
+// Run with DXVK_NULL_DEVICE=1 to measure CPU overhead only.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  const uint32_t drawCount     = 1000000;
+  const uint32_t drawsPerFlush = 1000;
+  const uint32_t textureCount  = 4;
+  
+  Com<ID3D11Device>         device;
+  Com<ID3D11DeviceContext>  context;
+  
+  if (FAILED(D3D11CreateDevice(
+        nullptr, D3D_DRIVER_TYPE_HARDWARE,
+        nullptr, 0, nullptr, 0, D3D11_SDK_VERSION,
+        &device, nullptr, &context))) {
+    std::cerr << "Failed to create D3D11 device" << std::endl;
+    return 1;
+  }
+  
+  Com<ID3DBlob> vsBlob;
+  Com<ID3DBlob> psBlob;
+  
+  if (FAILED(D3DCompile(g_vertexShaderCode.data(), g_vertexShaderCode.size(),
+        "Vertex shader", nullptr, nullptr, "main", "vs_5_0", 0, 0, &vsBlob, nullptr))
+   || FAILED(D3DCompile(g_pixelShaderCode.data(), g_pixelShaderCode.size(),
+        "Pixel shader", nullptr, nullptr, "main", "ps_5_0", 0, 0, &psBlob, nullptr))) {
+    std::cerr << "Failed to compile shaders" << std::endl;
+    return 1;
+  }
+  
+  Com<ID3D11VertexShader> vs;
+  Com<ID3D11PixelShader>  ps;
+  
+  if (FAILED(device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &vs))
+   || FAILED(device->CreatePixelShader (psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &ps))) {
+    std::cerr << "Failed to create shaders" << std::endl;
+    return 1;
+  }
+  
+  D3D11_BUFFER_DESC cbDesc;
+  cbDesc.ByteWidth            = 16;
+  cbDesc.Usage                = D3D11_USAGE_DYNAMIC;
+  cbDesc.BindFlags            = D3D11_BIND_CONSTANT_BUFFER;
+  cbDesc.CPUAccessFlags       = D3D11_CPU_ACCESS_WRITE;
+  cbDesc.MiscFlags            = 0;
+  cbDesc.StructureByteStride  = 0;
+  
+  Com<ID3D11Buffer> cb;
+  
+  if (FAILED(device->CreateBuffer(&cbDesc, nullptr, &cb))) {
+    std::cerr << "Failed to create constant buffer" << std::endl;
+    return 1;
+  }
+  
+  D3D11_TEXTURE2D_DESC texDesc;
+  texDesc.Width              = 256;
+  texDesc.Height             = 256;
+  texDesc.MipLevels          = 1;
+  texDesc.ArraySize          = 1;
+  texDesc.Format             = DXGI_FORMAT_R8G8B8A8_UNORM;
+  texDesc.SampleDesc.Count   = 1;
+  texDesc.SampleDesc.Quality = 0;
+  texDesc.Usage              = D3D11_USAGE_DEFAULT;
+  texDesc.BindFlags          = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+  texDesc.CPUAccessFlags     = 0;
+  texDesc.MiscFlags          = 0;
+  
+  Com<ID3D11Texture2D>          rtTexture;
+  Com<ID3D11RenderTargetView>   rtView;
+  
+  std::array<Com<ID3D11Texture2D>,          textureCount> textures;
+  std::array<Com<ID3D11ShaderResourceView>, textureCount> textureViews;
+  
+  if (FAILED(device->CreateTexture2D(&texDesc, nullptr, &rtTexture))
+   || FAILED(device->CreateRenderTargetView(rtTexture.ptr(), nullptr, &rtView))) {
+    std::cerr << "Failed to create render target" << std::endl;
+    return 1;
+  }
+  
+  for (uint32_t i = 0; i < textureCount; i++) {
+    if (FAILED(device->CreateTexture2D(&texDesc, nullptr, &textures[i]))
+     || FAILED(device->CreateShaderResourceView(textures[i].ptr(), nullptr, &textureViews[i]))) {
+      std::cerr << "Failed to create texture" << std::endl;
+      return 1;
+    }
+  }
+  
+  D3D11_SAMPLER_DESC samplerDesc;
+  std::memset(&samplerDesc, 0, sizeof(samplerDesc));
+  samplerDesc.Filter         = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+  samplerDesc.AddressU       = D3D11_TEXTURE_ADDRESS_CLAMP;
+  samplerDesc.AddressV       = D3D11_TEXTURE_ADDRESS_CLAMP;
+  samplerDesc.AddressW       = D3D11_TEXTURE_ADDRESS_CLAMP;
+  samplerDesc.ComparisonFunc = D3D11_COMPARISON_NEVER;
+  samplerDesc.MaxLOD         = D3D11_FLOAT32_MAX;
+  
+  Com<ID3D11SamplerState> sampler;
+  
+  if (FAILED(device->CreateSamplerState(&samplerDesc, &sampler))) {
+    std::cerr << "Failed to create sampler" << std::endl;
+    return 1;
+  }
+  
+  D3D11_QUERY_DESC queryDesc;
+  queryDesc.Query     = D3D11_QUERY_EVENT;
+  queryDesc.MiscFlags = 0;
+  
+  Com<ID3D11Query> query;
+  
+  if (FAILED(device->CreateQuery(&queryDesc, &query))) {
+    std::cerr << "Failed to create event query" << std::endl;
+    return 1;
+  }
+  
+  D3D11_VIEWPORT viewport = { 0.0f, 0.0f, 256.0f, 256.0f, 0.0f, 1.0f };
+  
+  context->OMSetRenderTargets(1, &rtView, nullptr);
+  context->RSSetViewports(1, &viewport);
+  context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+  context->VSSetShader(vs.ptr(), nullptr, 0);
+  context->VSSetConstantBuffers(0, 1, &cb);
+  context->PSSetShader(ps.ptr(), nullptr, 0);
+  context->PSSetSamplers(0, 1, &sampler);
+  
+  // Stage 1: Time spent on the application thread, i.e. D3D11
+  // state tracking and recording commands into CS chunks.
+  auto t0 = Clock::now();
+  
+  for (uint32_t i = 0; i < drawCount; i++) {
+    D3D11_MAPPED_SUBRESOURCE mapped;
+  
+    if (SUCCEEDED(context->Map(cb.ptr(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+      float offset[4] = { float(i & 0xFF), 0.0f, 0.0f, 0.0f };
+      std::memcpy(mapped.pData, offset, sizeof(offset));
+      context->Unmap(cb.ptr(), 0);
+    }
+  
+    context->PSSetShaderResources(0, 1, &textureViews[i % textureCount]);
+    context->Draw(4, 0);
+  
+    if ((i % drawsPerFlush) == drawsPerFlush - 1)
+      context->Flush();
+  }
+  
+  auto t1 = Clock::now();
+  
+  // Stage 2: Remaining time until the CS thread has executed
+  // all commands on the DXVK context and the GPU is done.
+  context->End(query.ptr());
+  context->Flush();
+  
+  while (context->GetData(query.ptr(), nullptr, 0, 0) != S_OK)
+    continue;
+  
+  auto t2 = Clock::now();
+  
+  const double recordNs = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  const double drainNs  = std::chrono::duration<double, std::nano>(t2 - t1).count();
+  const double totalNs  = std::chrono::duration<double, std::nano>(t2 - t0).count();
+  
+  std::cout << "Draws:             " << drawCount << std::endl;
+  std::cout << "Draws/sec:         " << uint64_t(1.0e9 * double(drawCount) / totalNs) << std::endl;
+  std::cout << "App thread:        " << (recordNs / double(drawCount)) << " ns/draw" << std::endl;
+  std::cout << "CS thread backlog: " << (drainNs  / double(drawCount)) << " ns/draw" << std::endl;
+  std::cout << "Total:             " << (totalNs  / double(drawCount)) << " ns/draw" << std::endl;
+  
+  context->ClearState();
+  return 0;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <dxvk_instance.h>
+
+namespace dxvk {
+  
+  /**
+   * \brief Buffer test fixture
+   * 
+   * Creates a buffer and a context to record
+   * commands with, and takes a snapshot of the
+   * device's stat counters so that tests can
+   * check how much a counter has changed.
+   */
+  struct DxvkBufferTest {
+    
+    DxvkBufferTest(
+      const Rc<DxvkDevice>&       device,
+            VkDeviceSize          size,
+            VkBufferUsageFlags    usage,
+            VkMemoryPropertyFlags memFlags)
+    : device(device) {
+      info.size   = size;
+      info.usage  = VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage;
+      info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT;
+      info.access = VK_ACCESS_TRANSFER_WRITE_BIT;
+      
+      buffer  = device->createBuffer(info, memFlags);
+      context = device->createContext();
+      
+      counters = device->getStatCounters();
+    }
+    
+    /**
+     * \brief Change of a stat counter
+     * 
+     * \param [in] ctr The counter
+     * \returns Difference between the current value
+     *          and the value when the test was set up
+     */
+    uint64_t getStatDiff(DxvkStatCounter ctr) const {
+      return device->getStatCounters().getCtr(ctr) - counters.getCtr(ctr);
+    }
+    
+    Rc<DxvkDevice>        device;
+    DxvkBufferCreateInfo  info;
+    Rc<DxvkBuffer>        buffer;
+    Rc<DxvkContext>       context;
+    DxvkStatCounters      counters;
+    
+  };
+  
+}
@@ -0,0 +1,55 @@
+#include <chrono>
+
+#include <dxvk_device.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-cs-bench.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  const uint32_t chunkCount    = 1000000;
+  const uint32_t cmdsPerChunk  = 16;
+  
+  // The commands never touch the context, so the
+  // benchmark only measures the cost of the handoff
+  DxvkCsThread csThread(nullptr, nullptr);
+  std::atomic<uint64_t> counter = { 0ull };
+  
+  auto t0 = Clock::now();
+  
+  for (uint32_t i = 0; i < chunkCount; i++) {
+    Rc<DxvkCsChunk> chunk = new DxvkCsChunk();
+    
+    for (uint32_t j = 0; j < cmdsPerChunk; j++) {
+      auto cmd = [&counter] (DxvkContext* ctx) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+      };
+      
+      chunk->push(cmd);
+    }
+    
+    csThread.dispatchChunk(std::move(chunk));
+  }
+  
+  csThread.synchronize();
+  
+  auto t1 = Clock::now();
+  
+  const double seconds = std::chrono::duration<double>(t1 - t0).count();
+  
+  std::cout << "Chunks:     " << chunkCount << std::endl;
+  std::cout << "Commands:   " << counter.load() << std::endl;
+  std::cout << "Time:       " << seconds << " s" << std::endl;
+  std::cout << "Chunks/sec: " << uint64_t(double(chunkCount) / seconds) << std::endl;
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include <chrono>
+#include <cstring>
+
+#include <dxvk_instance.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-draw-bench.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+// Measures the CPU cost of DxvkContext state tracking and
+// command recording, without any D3D11 front-end overhead.
+// Run with DXVK_NULL_DEVICE=1 to exclude the Vulkan driver.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  const uint32_t drawCount      = 1000000;
+  const uint32_t drawsPerSubmit = 1000;
+  const uint32_t textureCount   = 4;
+  
+  Rc<DxvkInstance> instance = new DxvkInstance();
+  Rc<DxvkDevice>   device   = instance->enumAdapters().at(0)
+    ->createDevice(VkPhysicalDeviceFeatures());
+  Rc<DxvkContext>  context  = device->createContext();
+  
+  const std::array<DxvkResourceSlot, 1> vsSlots = {{
+    { 0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_IMAGE_VIEW_TYPE_MAX_ENUM },
+  }};
+  
+  const std::array<DxvkResourceSlot, 2> fsSlots = {{
+    { 1, VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE,  VK_IMAGE_VIEW_TYPE_2D       },
+    { 2, VK_DESCRIPTOR_TYPE_SAMPLER,        VK_IMAGE_VIEW_TYPE_MAX_ENUM },
+  }};
+  
+  // Shader code is never compiled by the null device, so
+  // the benchmark does not need any actual SPIR-V code.
+  Rc<DxvkShader> vs = device->createShader(
+    VK_SHADER_STAGE_VERTEX_BIT, vsSlots.size(), vsSlots.data(),
+    DxvkInterfaceSlots(), SpirvCodeBuffer());
+  Rc<DxvkShader> fs = device->createShader(
+    VK_SHADER_STAGE_FRAGMENT_BIT, fsSlots.size(), fsSlots.data(),
+    DxvkInterfaceSlots(), SpirvCodeBuffer());
+  
+  DxvkImageCreateInfo imageInfo;
+  imageInfo.type        = VK_IMAGE_TYPE_2D;
+  imageInfo.format      = VK_FORMAT_R8G8B8A8_UNORM;
+  imageInfo.flags       = 0;
+  imageInfo.sampleCount = VK_SAMPLE_COUNT_1_BIT;
+  imageInfo.extent      = { 256, 256, 1 };
+  imageInfo.numLayers   = 1;
+  imageInfo.mipLevels   = 1;
+  imageInfo.usage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT
+                        | VK_IMAGE_USAGE_SAMPLED_BIT;
+  imageInfo.stages      = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+                        | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  imageInfo.access      = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+                        | VK_ACCESS_SHADER_READ_BIT;
+  imageInfo.tiling      = VK_IMAGE_TILING_OPTIMAL;
+  imageInfo.layout      = VK_IMAGE_LAYOUT_GENERAL;
+  
+  DxvkImageViewCreateInfo viewInfo;
+  viewInfo.type         = VK_IMAGE_VIEW_TYPE_2D;
+  viewInfo.format       = imageInfo.format;
+  viewInfo.aspect       = VK_IMAGE_ASPECT_COLOR_BIT;
+  viewInfo.minLevel     = 0;
+  viewInfo.numLevels    = 1;
+  viewInfo.minLayer     = 0;
+  viewInfo.numLayers    = 1;
+  
+  Rc<DxvkImageView> rtView = device->createImageView(
+    device->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+    viewInfo);
+  
+  std::array<Rc<DxvkImageView>, textureCount> textureViews;
+  
+  for (uint32_t i = 0; i < textureCount; i++) {
+    textureViews[i] = device->createImageView(
+      device->createImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+      viewInfo);
+  }
+  
+  DxvkRenderTargets renderTargets;
+  renderTargets.setColorTarget(0, rtView, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  
+  DxvkSamplerCreateInfo samplerInfo;
+  std::memset(&samplerInfo, 0, sizeof(samplerInfo));
+  samplerInfo.magFilter     = VK_FILTER_LINEAR;
+  samplerInfo.minFilter     = VK_FILTER_LINEAR;
+  samplerInfo.mipmapMode    = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+  samplerInfo.addressModeU  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.addressModeV  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.addressModeW  = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+  samplerInfo.compareOp     = VK_COMPARE_OP_NEVER;
+  samplerInfo.borderColor   = VK_BORDER_COLOR_FLOAT_TRANSPARENT_BLACK;
+  
+  DxvkBufferCreateInfo bufferInfo;
+  bufferInfo.size   = 256;
+  bufferInfo.usage  = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+  bufferInfo.stages = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+  bufferInfo.access = VK_ACCESS_UNIFORM_READ_BIT;
+  
+  Rc<DxvkBuffer> cb = device->createBuffer(bufferInfo,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  
+  DxvkRasterizerState rsState;
+  std::memset(&rsState, 0, sizeof(rsState));
+  rsState.polygonMode = VK_POLYGON_MODE_FILL;
+  rsState.cullMode    = VK_CULL_MODE_NONE;
+  rsState.frontFace   = VK_FRONT_FACE_CLOCKWISE;
+  
+  DxvkMultisampleState msState;
+  std::memset(&msState, 0, sizeof(msState));
+  msState.sampleMask  = 0xFFFFFFFF;
+  
+  DxvkDepthStencilState dsState;
+  std::memset(&dsState, 0, sizeof(dsState));
+  
+  DxvkLogicOpState loState;
+  std::memset(&loState, 0, sizeof(loState));
+  
+  DxvkBlendMode blendMode;
+  std::memset(&blendMode, 0, sizeof(blendMode));
+  blendMode.writeMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+                      | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+  
+  DxvkInputAssemblyState iaState;
+  std::memset(&iaState, 0, sizeof(iaState));
+  iaState.primitiveTopology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  
+  VkViewport viewport = { 0.0f, 0.0f, 256.0f, 256.0f, 0.0f, 1.0f };
+  VkRect2D   scissor  = { { 0, 0 }, { 256, 256 } };
+  
+  context->beginRecording(device->createCommandList());
+  context->setRasterizerState(rsState);
+  context->setMultisampleState(msState);
+  context->setDepthStencilState(dsState);
+  context->setLogicOpState(loState);
+  
+  for (uint32_t i = 0; i < MaxNumRenderTargets; i++)
+    context->setBlendMode(i, blendMode);
+  
+  context->setInputAssemblyState(iaState);
+  context->setInputLayout(0, nullptr, 0, nullptr);
+  context->bindFramebuffer(device->createFramebuffer(renderTargets));
+  context->setViewports(1, &viewport, &scissor);
+  context->bindShader(VK_SHADER_STAGE_VERTEX_BIT,   vs);
+  context->bindShader(VK_SHADER_STAGE_FRAGMENT_BIT, fs);
+  context->bindResourceSampler(2, device->createSampler(samplerInfo));
+  
+  auto t0 = Clock::now();
+  
+  for (uint32_t i = 0; i < drawCount; i++) {
+    // Mimics a D3D11 constant buffer update with WRITE_DISCARD
+    DxvkPhysicalBufferSlice slice = cb->allocPhysicalSlice();
+    std::memcpy(slice.mapPtr(0), &i, sizeof(i));
+  
+    context->invalidateBuffer(cb, slice);
+    context->bindResourceBuffer(0, DxvkBufferSlice(cb));
+    context->bindResourceView(1, textureViews[i % textureCount], nullptr);
+    context->draw(3, 1, 0, 0);
+  
+    if ((i % drawsPerSubmit) == drawsPerSubmit - 1) {
+      device->submitCommandList(context->endRecording(), nullptr, nullptr);
+      context->beginRecording(device->createCommandList());
+    }
+  }
+  
+  auto t1 = Clock::now();
+  
+  device->submitCommandList(context->endRecording(), nullptr, nullptr);
+  device->waitForIdle();
+  
+  auto t2 = Clock::now();
+  
+  const double recordNs = std::chrono::duration<double, std::nano>(t1 - t0).count();
+  const double totalNs  = std::chrono::duration<double, std::nano>(t2 - t0).count();
+  
+  std::cout << "Draws:     " << drawCount << std::endl;
+  std::cout << "Draws/sec: " << uint64_t(1.0e9 * double(drawCount) / totalNs) << std::endl;
+  std::cout << "Recording: " << (recordNs / double(drawCount)) << " ns/draw" << std::endl;
+  std::cout << "Total:     " << (totalNs  / double(drawCount)) << " ns/draw" << std::endl;
+  return 0;
+}
@@ -0,0 +1,470 @@
+#include <chrono>
+#include <random>
+#include <thread>
+
+#include <dxvk_instance.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-memory-bench.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+const VkDeviceSize ChunkSize = 16 * 1024 * 1024;
+
+VkMemoryRequirements memoryRequirements(VkDeviceSize size, VkDeviceSize align) {
+  VkMemoryRequirements req;
+  req.size           = size;
+  req.alignment      = align;
+  req.memoryTypeBits = ~0u;
+  return req;
+}
+
+
+// Allocates and frees randomly sized slices in a steady state
+// and reports how much device memory backs the live set.
+bool runBenchmark(const Rc<DxvkMemoryAllocator>& allocator) {
+  const uint32_t liveCount      = 4096;
+  const uint32_t iterationCount = 1000000;
+  
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<VkDeviceSize> sizeDist(256, 256 * 1024);
+  std::uniform_int_distribution<uint32_t>     slotDist(0, liveCount - 1);
+  std::uniform_int_distribution<uint32_t>     alignDist(0, 4);
+  
+  std::vector<DxvkMemory> slices(liveCount);
+  
+  auto t0 = Clock::now();
+  
+  for (uint32_t i = 0; i < iterationCount; i++) {
+    const uint32_t     slot  = slotDist(rng);
+    const VkDeviceSize size  = sizeDist(rng);
+    const VkDeviceSize align = VkDeviceSize(256) << alignDist(rng);
+    
+    slices[slot] = DxvkMemory();
+    slices[slot] = allocator->alloc(memoryRequirements(size, align),
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  }
+  
+  auto t1 = Clock::now();
+  
+  uint32_t     chunkCount      = 0;
+  VkDeviceSize memoryAllocated = 0;
+  VkDeviceSize memoryUsed      = 0;
+  
+  for (const auto& stats : allocator->getStats()) {
+    chunkCount      += stats.chunkCount;
+    memoryAllocated += stats.memoryAllocated;
+    memoryUsed      += stats.memoryUsed;
+  }
+  
+  const double seconds = std::chrono::duration<double>(t1 - t0).count();
+  const double usage   = double(memoryUsed) / double(memoryAllocated);
+  
+  std::cout << "Operations:     " << iterationCount << std::endl;
+  std::cout << "Operations/sec: " << uint64_t(double(iterationCount) / seconds) << std::endl;
+  std::cout << "Time:           " << (1.0e9 * seconds / double(iterationCount)) << " ns/op" << std::endl;
+  std::cout << "Chunks:         " << chunkCount << std::endl;
+  std::cout << "Utilization:    " << (100.0 * usage) << "%" << std::endl;
+  return true;
+}
+
+
+// Runs the same random workload on multiple threads at
+// once and reports the combined allocation throughput.
+// Checks that all memory is freed once the threads exit.
+bool runThreadBenchmark(const Rc<DxvkMemoryAllocator>& allocator, uint32_t threadCount) {
+  const uint32_t liveCount      = 256;
+  const uint32_t iterationCount = 200000;
+  
+  auto threadFunc = [&allocator] (uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<VkDeviceSize> sizeDist(256, 64 * 1024);
+    std::uniform_int_distribution<uint32_t>     slotDist(0, liveCount - 1);
+    
+    std::vector<DxvkMemory> slices(liveCount);
+    
+    for (uint32_t i = 0; i < iterationCount; i++) {
+      const uint32_t slot = slotDist(rng);
+      
+      slices[slot] = DxvkMemory();
+      slices[slot] = allocator->alloc(memoryRequirements(sizeDist(rng), 256),
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+  };
+  
+  std::vector<std::thread> threads;
+  
+  auto t0 = Clock::now();
+  
+  for (uint32_t i = 0; i < threadCount; i++)
+    threads.emplace_back(threadFunc, i);
+  
+  for (auto& thread : threads)
+    thread.join();
+  
+  auto t1 = Clock::now();
+  
+  const double seconds    = std::chrono::duration<double>(t1 - t0).count();
+  const double operations = double(iterationCount) * double(threadCount);
+  
+  std::cout << "Threads: " << threadCount << ", "
+            << uint64_t(operations / seconds) << " ops/sec" << std::endl;
+  
+  for (const auto& stats : allocator->getStats()) {
+    if (stats.memoryUsed != 0) {
+      std::cerr << "Memory not freed by threads" << std::endl;
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+
+// Punches holes into a chunk and checks that freed
+// neighbours are merged back into a single block.
+bool runFragmentationTest(const Rc<DxvkMemoryAllocator>& allocator) {
+  const VkDeviceSize smallSize = 64 * 1024;
+  const uint32_t     count     = uint32_t(ChunkSize / smallSize);
+  
+  std::vector<DxvkMemory> slices(count);
+  
+  for (uint32_t i = 0; i < count; i++) {
+    slices[i] = allocator->alloc(memoryRequirements(smallSize, 256),
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  }
+  
+  const VkDeviceMemory chunk = slices[0].memory();
+  
+  for (uint32_t i = 0; i < count; i++) {
+    if (slices[i].memory() != chunk) {
+      std::cerr << "Slices not packed into a single chunk" << std::endl;
+      return false;
+    }
+  }
+  
+  // Every other slice is freed, so there is no free
+  // range large enough for two consecutive slices
+  for (uint32_t i = 0; i < count; i += 2)
+    slices[i] = DxvkMemory();
+  
+  DxvkMemory large = allocator->alloc(memoryRequirements(2 * smallSize, 256),
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  
+  if (large.memory() == chunk) {
+    std::cerr << "Allocated from a fragmented range" << std::endl;
+    return false;
+  }
+  
+  large = DxvkMemory();
+  
+  for (uint32_t i = 1; i < count; i += 2)
+    slices[i] = DxvkMemory();
+  
+  // All holes are freed, so the entire chunk must
+  // be available to large allocations again.
+  large = allocator->alloc(memoryRequirements(ChunkSize / 4 - 256, 256),
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  
+  if (large.memory() != chunk || large.offset() != 0) {
+    std::cerr << "Free ranges not merged" << std::endl;
+    return false;
+  }
+  
+  std::cout << "Fragmentation:  passed" << std::endl;
+  return true;
+}
+
+
+// Frees memory on one thread and allocates the same amount on
+// another one, which checks that threads use free space in chunks
+// owned by other stripes instead of allocating new device memory.
+bool runStripeTest(const Rc<DxvkMemoryAllocator>& allocator) {
+  const VkDeviceSize sliceSize  = 64 * 1024;
+  const uint32_t     sliceCount = uint32_t(ChunkSize / sliceSize) / 2;
+  
+  auto allocSlices = [&allocator] (std::vector<DxvkMemory>& slices) {
+    for (auto& slice : slices) {
+      slice = allocator->alloc(memoryRequirements(sliceSize, 256),
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    }
+  };
+  
+  auto getAllocated = [&allocator] () {
+    VkDeviceSize memoryAllocated = 0;
+    
+    for (const auto& stats : allocator->getStats())
+      memoryAllocated += stats.memoryAllocated;
+    
+    return memoryAllocated;
+  };
+  
+  std::vector<DxvkMemory> slices(sliceCount);
+  
+  std::thread(allocSlices, std::ref(slices)).join();
+  slices = std::vector<DxvkMemory>(sliceCount);
+  
+  const VkDeviceSize before = getAllocated();
+  std::thread(allocSlices, std::ref(slices)).join();
+  const VkDeviceSize after  = getAllocated();
+  
+  if (after != before) {
+    std::cerr << "Stripes allocated new memory: "
+              << (before >> 10) << " kB before, "
+              << (after  >> 10) << " kB after" << std::endl;
+    return false;
+  }
+  
+  std::cout << "Stripes:        passed" << std::endl;
+  return true;
+}
+
+
+// Allocates more device-local memory than the device has
+// and checks that allocations get demoted instead of failing.
+bool runOversubscriptionTest(const Rc<DxvkAdapter>& adapter, const Rc<DxvkMemoryAllocator>& allocator) {
+  const VkPhysicalDeviceMemoryProperties memProps = adapter->memoryProperties();
+  const VkDeviceSize blockSize = 64 * 1024 * 1024;
+  
+  VkDeviceSize deviceMemory = 0;
+  
+  for (uint32_t i = 0; i < memProps.memoryHeapCount; i++) {
+    if (memProps.memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT)
+      deviceMemory += memProps.memoryHeaps[i].size;
+  }
+  
+  std::vector<DxvkMemory> blocks;
+  
+  // Devices without a separate system memory heap
+  // can only go over budget, which is fine as well
+  auto fellBack = [&allocator] {
+    const DxvkStatCounters counters = allocator->getStatCounters();
+    return counters.getCtr(DxvkStatCounter::MemoryDemotionCount) != 0
+        || counters.getCtr(DxvkStatCounter::MemoryOverBudget)    != 0;
+  };
+  
+  try {
+    while (!fellBack()) {
+      if (blocks.size() * blockSize > deviceMemory) {
+        std::cerr << "Device memory budget not enforced" << std::endl;
+        return false;
+      }
+      
+      blocks.push_back(allocator->alloc(memoryRequirements(blockSize, 256),
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+    }
+  } catch (const DxvkError& e) {
+    std::cerr << e.message() << std::endl;
+    return false;
+  }
+  
+  std::cout << "Fallback:       after " << ((blocks.size() * blockSize) >> 20) << " MB" << std::endl;
+  return true;
+}
+
+
+// Creates a render target and checks whether the driver's
+// preference for a dedicated allocation was honored.
+bool runDedicatedTest(const Rc<DxvkDevice>& device) {
+  DxvkImageCreateInfo info;
+  info.type        = VK_IMAGE_TYPE_2D;
+  info.format      = VK_FORMAT_R8G8B8A8_UNORM;
+  info.flags       = 0;
+  info.sampleCount = VK_SAMPLE_COUNT_1_BIT;
+  info.extent      = VkExtent3D { 1920, 1080, 1 };
+  info.numLayers   = 1;
+  info.mipLevels   = 1;
+  info.usage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+  info.stages      = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  info.access      = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+  info.tiling      = VK_IMAGE_TILING_OPTIMAL;
+  info.layout      = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+  
+  auto getDedicatedCount = [&device] () {
+    uint32_t dedicatedCount = 0;
+    
+    for (const auto& stats : device->getMemoryStats())
+      dedicatedCount += stats.driverDedicatedCount;
+    
+    return dedicatedCount;
+  };
+  
+  const uint32_t countBefore = getDedicatedCount();
+  
+  Rc<DxvkImage> image = device->createImage(info,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  
+  const uint32_t countAlloc = getDedicatedCount();
+  
+  image = nullptr;
+  
+  const uint32_t countAfter = getDedicatedCount();
+  
+  std::cout << "Dedicated:      " << (countAlloc - countBefore) << " requested by driver" << std::endl;
+  
+  // The null device prefers dedicated allocations for
+  // attachments, so the render target must get one
+  if (countAlloc <= countBefore) {
+    std::cerr << "Dedicated allocation not used" << std::endl;
+    return false;
+  }
+  
+  if (countAfter != countBefore) {
+    std::cerr << "Dedicated allocation not released" << std::endl;
+    return false;
+  }
+  
+  return true;
+}
+
+
+// Leaves device memory chunks sparsely populated and checks
+// that the defragmenter moves the remaining buffers out.
+bool runDefragTest(const Rc<DxvkDevice>& device) {
+  if (!device->hasOption(DxvkOption::DefragmentMemory)) {
+    std::cout << "Defrag:         skipped, set DXVK_DEFRAGMENT_MEMORY=1" << std::endl;
+    return true;
+  }
+  
+  DxvkBufferCreateInfo info;
+  info.size   = 256 * 1024;
+  info.usage  = VK_BUFFER_USAGE_TRANSFER_SRC_BIT
+              | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+              | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+  info.stages = VK_PIPELINE_STAGE_TRANSFER_BIT
+              | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+  info.access = VK_ACCESS_TRANSFER_READ_BIT
+              | VK_ACCESS_TRANSFER_WRITE_BIT
+              | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+  
+  std::vector<Rc<DxvkBuffer>> buffers;
+  
+  for (uint32_t i = 0; i < 1024; i++)
+    buffers.push_back(device->createBuffer(info, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+  
+  // Keep every eighth buffer alive
+  for (uint32_t i = 0; i < buffers.size(); i++) {
+    if (i % 8 != 0)
+      buffers[i] = nullptr;
+  }
+  
+  auto getLargestFreeBlock = [&device] {
+    VkDeviceSize result = 0;
+    
+    for (const auto& stats : device->getMemoryStats())
+      result = std::max(result, stats.largestFreeBlock);
+    return result;
+  };
+  
+  const VkDeviceSize freeBlockBefore = getLargestFreeBlock();
+  
+  Rc<DxvkContext> ctx = device->createContext();
+  uint64_t movedBuffers = ~0ull;
+  
+  // Run steps until the pass ends, which is the
+  // case once no more buffers have been moved
+  while (movedBuffers != device->getStatCounters().getCtr(DxvkStatCounter::MemoryMovedBuffers)) {
+    movedBuffers = device->getStatCounters().getCtr(DxvkStatCounter::MemoryMovedBuffers);
+    
+    ctx->beginRecording(device->createCommandList());
+    device->defragmentMemory(ctx.ptr(), device->getDefragSerial());
+    device->submitCommandList(ctx->endRecording(), nullptr, nullptr);
+    device->waitForIdle();
+  }
+  
+  const VkDeviceSize freeBlockAfter = getLargestFreeBlock();
+  
+  std::cout << "Defrag:         " << movedBuffers << " buffers moved, largest free block "
+            << (freeBlockBefore >> 10) << " kB -> " << (freeBlockAfter >> 10) << " kB" << std::endl;
+  
+  if (movedBuffers == 0 || freeBlockAfter <= freeBlockBefore) {
+    std::cerr << "Memory not defragmented" << std::endl;
+    return false;
+  }
+  
+  return true;
+}
+
+
+// Fills three chunks and leaves two of them sparsely used. Once
+// the first sparse chunk is marked for evacuation, the remaining
+// free space cannot hold the live data of the second one, so
+// only one chunk may be selected for defragmentation.
+bool runDefragLimitTest(const Rc<DxvkMemoryAllocator>& allocator) {
+  const VkDeviceSize sliceSize  = 256 * 1024;
+  const uint32_t     sliceCount = uint32_t(ChunkSize / sliceSize);
+  
+  std::vector<DxvkMemory> slices(3 * sliceCount);
+  
+  for (auto& slice : slices) {
+    slice = allocator->alloc(memoryRequirements(sliceSize, 256),
+      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  }
+  
+  if (slices[0].memory() == slices[sliceCount].memory()
+   || slices[sliceCount].memory() == slices[2 * sliceCount].memory()) {
+    std::cerr << "Slices not packed into separate chunks" << std::endl;
+    return false;
+  }
+  
+  // Keep the second chunk full and four slices in the others
+  for (uint32_t i = 0; i < slices.size(); i++) {
+    if (i / sliceCount != 1 && i % sliceCount >= 4)
+      slices[i] = DxvkMemory();
+  }
+  
+  const uint32_t count = allocator->beginDefrag();
+  allocator->endDefrag();
+  
+  std::cout << "Defrag limit:   " << count << " chunks selected" << std::endl;
+  
+  if (count != 1) {
+    std::cerr << "Defrag selected chunks without enough free space" << std::endl;
+    return false;
+  }
+  
+  return true;
+}
+
+
+// Tests and benchmarks the device memory allocator as well as
+// the defragmentation code built on top of it. Run with
+// DXVK_NULL_DEVICE=1 to exclude the Vulkan driver from the timings.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  Rc<DxvkInstance> instance = new DxvkInstance();
+  Rc<DxvkAdapter>  adapter  = instance->enumAdapters().at(0);
+  Rc<DxvkDevice>   device   = adapter->createDevice(VkPhysicalDeviceFeatures());
+  
+  // Use separate allocators so that the fragmentation
+  // test starts out without any pre-existing chunks
+  const bool fragResult = runFragmentationTest(
+    new DxvkMemoryAllocator(adapter, device->vkd(), device->extensions()));
+  const bool benchResult = runBenchmark(
+    new DxvkMemoryAllocator(adapter, device->vkd(), device->extensions()));
+  const bool stripeResult = runStripeTest(
+    new DxvkMemoryAllocator(adapter, device->vkd(), device->extensions()));
+  const bool dedicatedResult = runDedicatedTest(device);
+  const bool oversubResult = runOversubscriptionTest(adapter,
+    new DxvkMemoryAllocator(adapter, device->vkd(), device->extensions()));
+  const bool defragResult = runDefragTest(device);
+  const bool defragLimitResult = runDefragLimitTest(
+    new DxvkMemoryAllocator(adapter, device->vkd(), device->extensions()));
+  
+  Rc<DxvkMemoryAllocator> allocator = new DxvkMemoryAllocator(adapter, device->vkd(), device->extensions());
+  
+  bool threadResult = true;
+  
+  for (uint32_t i = 1; i <= 16; i *= 2)
+    threadResult &= runThreadBenchmark(allocator, i);
+  
+  return (fragResult && benchResult && stripeResult && dedicatedResult && oversubResult && defragResult && defragLimitResult && threadResult) ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <vector>
+
+#include <dxvk_format.h>
+#include <dxvk_pack.h>
+#include <dxvk_util.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-pack-bench.log");
+}
+
+using namespace dxvk;
+
+using Clock = std::chrono::high_resolution_clock;
+
+struct PackTestCase {
+  const char*   name;
+  VkFormat      format;
+  VkExtent3D    extent;
+  uint32_t      mipLevels;
+};
+
+struct PackTestIsa {
+  const char*   name;
+  util::PackIsa isa;
+};
+
+const std::array<PackTestIsa, 3> g_isas = {{
+  { "scalar", util::PackIsa::Scalar },
+  { "sse2",   util::PackIsa::Sse2   },
+  { "avx2",   util::PackIsa::Avx2   },
+}};
+
+// Extents are deliberately not multiples of 64 pixels, so that
+// the D3D row pitch differs from the tightly packed row size.
+const std::array<PackTestCase, 8> g_cases = {{
+  { "RGBA8 2D 1000x1000",       VK_FORMAT_R8G8B8A8_UNORM,       { 1000, 1000,   1 }, 1 },
+  { "RGBA8 2D 1000x1000 mips",  VK_FORMAT_R8G8B8A8_UNORM,       { 1000, 1000,   1 }, 10 },
+  { "R8 2D 250x250 mips",       VK_FORMAT_R8_UNORM,             {  250,  250,   1 }, 8 },
+  { "RGBA32F 2D 60x60",         VK_FORMAT_R32G32B32A32_SFLOAT,  {   60,   60,   1 }, 1 },
+  { "BC1 2D 1000x1000",         VK_FORMAT_BC1_RGBA_UNORM_BLOCK, { 1000, 1000,   1 }, 1 },
+  { "BC3 2D 1000x1000 mips",    VK_FORMAT_BC3_UNORM_BLOCK,      { 1000, 1000,   1 }, 10 },
+  { "BC7 2D 500x500",           VK_FORMAT_BC7_UNORM_BLOCK,      {  500,  500,   1 }, 1 },
+  { "RGBA16F 3D 100x100x100",   VK_FORMAT_R16G16B16A16_SFLOAT,  {  100,  100, 100 }, 1 },
+}};
+
+
+struct PackTestLevel {
+  VkExtent3D    blockCount;
+  VkDeviceSize  rowPitch;
+  VkDeviceSize  layerPitch;
+  VkDeviceSize  srcOffset;
+  VkDeviceSize  dstOffset;
+};
+
+
+void packLevels(
+        util::PackIsa                 isa,
+        char*                         dstData,
+  const char*                         srcData,
+        VkDeviceSize                  blockSize,
+  const std::vector<PackTestLevel>&   levels) {
+  for (const auto& level : levels) {
+    const VkDeviceSize bytesPerRow   = level.blockCount.width  * blockSize;
+    const VkDeviceSize bytesPerLayer = level.blockCount.height * bytesPerRow;
+    
+    for (uint32_t z = 0; z < level.blockCount.depth; z++) {
+      util::copyImageRows(isa,
+        dstData + level.dstOffset + z * bytesPerLayer,
+        srcData + level.srcOffset + z * level.layerPitch,
+        bytesPerRow, level.blockCount.height,
+        bytesPerRow, level.rowPitch);
+    }
+  }
+}
+
+
+// Repacks the subresources of a texture from a D3D-style layout with
+// 256-byte aligned row pitches into a tightly packed buffer, using
+// each supported kernel, and checks the result against the scalar one.
+bool runPackTest(const PackTestCase& test) {
+  const DxvkFormatInfo* formatInfo = imageFormatInfo(test.format);
+  
+  std::vector<PackTestLevel> levels;
+  VkDeviceSize srcSize = 0;
+  VkDeviceSize dstSize = 0;
+  
+  for (uint32_t i = 0; i < test.mipLevels; i++) {
+    const VkExtent3D levelExtent = {
+      std::max(test.extent.width  >> i, 1u),
+      std::max(test.extent.height >> i, 1u),
+      std::max(test.extent.depth  >> i, 1u) };
+    
+    PackTestLevel level;
+    level.blockCount = util::computeBlockCount(levelExtent, formatInfo->blockSize);
+    level.rowPitch   = align(level.blockCount.width * formatInfo->elementSize, 256);
+    level.layerPitch = level.rowPitch * level.blockCount.height;
+    level.srcOffset  = srcSize;
+    level.dstOffset  = dstSize;
+    levels.push_back(level);
+    
+    srcSize += level.layerPitch * level.blockCount.depth;
+    dstSize += formatInfo->elementSize * util::flattenImageExtent(level.blockCount);
+  }
+  
+  std::vector<char> srcData(srcSize);
+  std::vector<char> refData(dstSize);
+  std::vector<char> dstData(dstSize);
+  
+  for (size_t i = 0; i < srcData.size(); i++)
+    srcData[i] = char(i * 7 + (i >> 8));
+  
+  packLevels(util::PackIsa::Scalar, refData.data(),
+    srcData.data(), formatInfo->elementSize, levels);
+  
+  bool result = true;
+  
+  std::cout << std::left << std::setw(26) << test.name;
+  
+  for (const auto& isa : g_isas) {
+    if (!util::isPackIsaSupported(isa.isa)) {
+      std::cout << std::setw(8) << isa.name << std::setw(10) << "n/a";
+      continue;
+    }
+    
+    std::memset(dstData.data(), 0, dstData.size());
+    
+    uint64_t iterations = 0;
+    double   seconds    = 0.0;
+    
+    auto t0 = Clock::now();
+    
+    while (seconds < 0.2) {
+      packLevels(isa.isa, dstData.data(),
+        srcData.data(), formatInfo->elementSize, levels);
+      
+      iterations += 1;
+      seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+    
+    const double gbps = double(dstSize * iterations) / (seconds * 1.0e9);
+    
+    std::cout << std::setw(8) << isa.name << std::fixed
+              << std::setprecision(2) << std::setw(10) << gbps;
+    
+    if (std::memcmp(dstData.data(), refData.data(), dstSize)) {
+      std::cerr << std::endl << isa.name << ": Data mismatch" << std::endl;
+      result = false;
+    }
+  }
+  
+  std::cout << " GB/s" << std::endl;
+  return result;
+}
+
+
+// Measures the throughput of the image repacking kernels used
+// when uploading texture data with non-packed row pitches.
+// This does not require a Vulkan device.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  bool result = true;
+  
+  for (const auto& test : g_cases)
+    result &= runPackTest(test);
+  
+  return result ? 0 : 1;
+}
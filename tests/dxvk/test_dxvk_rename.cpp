@@ -0,0 +1,59 @@
+#include <dxvk_instance.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+#include "test_dxvk_buffer.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-rename-bench.log");
+}
+
+using namespace dxvk;
+
+// Discards a buffer that is in use by the GPU many times
+// and checks that the renaming pool grows accordingly.
+bool runRenameTest(const Rc<DxvkDevice>& device) {
+  DxvkBufferTest test(device, 256, 0,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  
+  const uint32_t discardCount = 4096;
+  
+  test.context->beginRecording(device->createCommandList());
+  
+  for (uint32_t i = 0; i < discardCount; i++) {
+    test.context->invalidateBuffer(test.buffer, test.buffer->allocPhysicalSlice());
+    test.context->clearBuffer(test.buffer, 0, test.info.size, i);
+  }
+  
+  device->submitCommandList(test.context->endRecording(), nullptr, nullptr);
+  device->waitForIdle();
+  
+  const uint64_t renames  = test.getStatDiff(DxvkStatCounter::BufferRenameCount);
+  const uint64_t reallocs = test.getStatDiff(DxvkStatCounter::BufferReallocCount);
+  
+  std::cout << "Discards:       " << renames << " renames, " << reallocs << " reallocations" << std::endl;
+  
+  // The pool must at least double in size every
+  // time it runs out of slices that are not in use
+  if (renames != discardCount || reallocs > 32) {
+    std::cerr << "Unexpected number of buffer reallocations" << std::endl;
+    return false;
+  }
+  
+  return true;
+}
+
+
+// Tests the buffer renaming pool that serves discards
+// of buffers which are still in use by the GPU.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  Rc<DxvkInstance> instance = new DxvkInstance();
+  Rc<DxvkAdapter>  adapter  = instance->enumAdapters().at(0);
+  Rc<DxvkDevice>   device   = adapter->createDevice(VkPhysicalDeviceFeatures());
+  
+  return runRenameTest(device) ? 0 : 1;
+}
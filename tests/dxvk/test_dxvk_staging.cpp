@@ -0,0 +1,80 @@
+#include <cstring>
+#include <vector>
+
+#include <dxvk_instance.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+#include "test_dxvk_buffer.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-staging-bench.log");
+}
+
+using namespace dxvk;
+
+// Streams uploads from several command lists per frame and checks
+// that the staging ring reuses its buffers instead of allocating.
+bool runStagingTest(const Rc<DxvkDevice>& device) {
+  DxvkBufferTest test(device, 16 << 20, 0,
+    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+  
+  std::vector<char> data(8 << 20);
+  
+  // Each frame streams a number of small uploads as well
+  // as one large upload from multiple command lists
+  for (uint32_t frame = 0; frame < 64; frame++) {
+    for (uint32_t cmd = 0; cmd < 3; cmd++) {
+      test.context->beginRecording(device->createCommandList());
+      
+      for (uint32_t i = 0; i < 64; i++)
+        test.context->updateBuffer(test.buffer, i << 16, 1 << 16, data.data());
+      
+      test.context->updateBuffer(test.buffer, 0, data.size(), data.data());
+      
+      // Initial data uploads fill their slice before recording
+      const DxvkBufferSlice slice = device->allocStagingData(1 << 20);
+      std::memcpy(slice.mapPtr(0), data.data(), slice.length());
+      
+      test.context->copyBuffer(test.buffer, 0,
+        slice.buffer(), slice.offset(), slice.length());
+      device->submitCommandList(test.context->endRecording(), nullptr, nullptr);
+    }
+    
+    device->waitForIdle();
+  }
+  
+  const uint64_t stagedBytes = test.getStatDiff(DxvkStatCounter::StagingBytes);
+  const uint64_t wraparounds = test.getStatDiff(DxvkStatCounter::StagingRingWraps);
+  const uint64_t allocations = test.getStatDiff(DxvkStatCounter::StagingAllocCount);
+  
+  std::cout << "Staging:        " << (stagedBytes >> 20) << " MB staged, "
+            << wraparounds << " wraparounds, "
+            << allocations << " buffers allocated" << std::endl;
+  
+  // Command lists are reset asynchronously once their fence
+  // signals, so up to two frames worth of command lists may
+  // hold on to staging buffers. Each command list uses one
+  // buffer from each of the two size classes involved.
+  if (allocations > 12) {
+    std::cerr << "Staging buffers allocated while streaming" << std::endl;
+    return false;
+  }
+  
+  return true;
+}
+
+
+// Tests the staging ring that backs buffer updates
+// and initial data uploads.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  Rc<DxvkInstance> instance = new DxvkInstance();
+  Rc<DxvkAdapter>  adapter  = instance->enumAdapters().at(0);
+  Rc<DxvkDevice>   device   = adapter->createDevice(VkPhysicalDeviceFeatures());
+  
+  return runStagingTest(device) ? 0 : 1;
+}
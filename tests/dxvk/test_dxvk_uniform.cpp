@@ -0,0 +1,77 @@
+#include <unordered_set>
+
+#include <dxvk_instance.h>
+
+#include <windows.h>
+#include <windowsx.h>
+
+#include "test_dxvk_buffer.h"
+
+namespace dxvk {
+  Logger Logger::s_instance("dxvk-uniform-bench.log");
+}
+
+using namespace dxvk;
+
+// Sub-allocates uniform buffer slices in a loop and checks
+// that ring buffers get reused once they are no longer used.
+bool runUniformRingTest(const Rc<DxvkDevice>& device) {
+  DxvkBufferTest test(device, 256, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+    VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+  
+  std::unordered_set<VkBuffer> ringBuffers;
+  
+  for (uint32_t frame = 0; frame < 64; frame++) {
+    test.context->beginRecording(device->createCommandList());
+    
+    for (uint32_t i = 0; i < 4096; i++) {
+      DxvkPhysicalBufferSlice slice;
+      
+      if (!device->allocUniformSlice(test.info.size, slice)) {
+        std::cerr << "Uniform ring allocation failed" << std::endl;
+        return false;
+      }
+      
+      ringBuffers.insert(slice.handle());
+      
+      test.context->invalidateBuffer(test.buffer, slice);
+      test.context->clearBuffer(test.buffer, 0, test.info.size, i);
+    }
+    
+    device->submitCommandList(test.context->endRecording(), nullptr, nullptr);
+    device->waitForIdle();
+  }
+  
+  const uint64_t renames = test.getStatDiff(DxvkStatCounter::BufferRenameCount);
+  
+  std::cout << "Uniform ring:   " << ringBuffers.size() << " ring buffers used" << std::endl;
+  
+  // Slices allocated from the ring are buffer discards as well
+  if (renames != 64 * 4096) {
+    std::cerr << "Uniform ring discards not counted" << std::endl;
+    return false;
+  }
+  
+  // One frame fits into a single ring buffer, and
+  // the buffer in use by the GPU must not be reused
+  if (ringBuffers.size() > 2) {
+    std::cerr << "Uniform ring buffers not reused" << std::endl;
+    return false;
+  }
+  
+  return true;
+}
+
+
+// Tests the uniform buffer ring that serves discards
+// of small constant buffers.
+int WINAPI WinMain(HINSTANCE hInstance,
+                   HINSTANCE hPrevInstance,
+                   LPSTR lpCmdLine,
+                   int nCmdShow) {
+  Rc<DxvkInstance> instance = new DxvkInstance();
+  Rc<DxvkAdapter>  adapter  = instance->enumAdapters().at(0);
+  Rc<DxvkDevice>   device   = adapter->createDevice(VkPhysicalDeviceFeatures());
+  
+  return runUniformRingTest(device) ? 0 : 1;
+}